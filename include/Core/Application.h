@@ -21,9 +21,10 @@ public:
 
   void Run();
 
+  static std::unique_ptr<BaseFolders> FindBaseFolders();
+
 private:
   void switchMode(Mode mode);
-  void findBaseFolders();
 
   void processInput();
 
@@ -40,12 +41,13 @@ private:
   std::vector<std::string> mModeNames = {"CameraCalibration", "Viewport3D"};
   Mode mCurrentMode;
   IAppMode *mCurrentAppMode;
+  // Before the modes, their quads and meshes unpin textures on destruction
+  std::unique_ptr<TextureManager> mTextureManager;
   std::unique_ptr<CameraCalibrator> mCameraCalibrator;
   std::unique_ptr<Viewport> mViewport;
 
   std::unique_ptr<BaseFolders> mBaseFolders;
 
-  std::unique_ptr<TextureManager> mTextureManager;
   std::unique_ptr<ExampleLoader> mExampleLoader;
   std::unique_ptr<TutorialLoader> mTutorialLoader;
 
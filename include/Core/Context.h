@@ -10,19 +10,25 @@ enum class Theme { Light, Dark };
 
 class Context {
 public:
-  Context(std::string &configsFolder);
+  Context(std::string &configsFolder, bool headless = false);
   ~Context();
   void StartFrame();
   void EndFrame();
 
   GLFWwindow *GetWindow() const { return mWindow; }
+  bool IsHeadless() const { return mHeadless; }
+  // False when no window, offscreen context or GL loader could be created
+  bool IsValid() const { return mValid; }
 
   void SetImGuiStyle(const Theme &theme);
 
 private:
   void setupImGui();
+  GLFWwindow *createHeadlessWindow();
 
 private:
   GLFWwindow *mWindow = nullptr;
   std::string mConfigsFolder;
+  bool mHeadless = false;
+  bool mValid = false;
 };
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Rendering/Shaders/Renderer.h"
+#include "Utilities/Serialize.h"
+
+#include <glm/glm.hpp>
+#include <string>
+
+namespace Random {
+class Stream;
+}
+
+// Ranges every sample is drawn from, {min, max}. Angles are in degrees,
+// the world is z up.
+struct RandomizationSettings {
+  glm::ivec2 LightCount = glm::ivec2(1, 2);
+  glm::vec2 LightElevation = glm::vec2(25.0f, 75.0f);
+  glm::vec2 LightIntensity = glm::vec2(0.6f, 1.0f);
+  // Negative is cooler (blue), positive warmer (red)
+  glm::vec2 LightWarmth = glm::vec2(-0.15f, 0.15f);
+  glm::vec2 Ambient = glm::vec2(0.3f, 0.5f);
+  // Per channel multiplier on every material
+  glm::vec2 Tint = glm::vec2(0.9f, 1.1f);
+  // Standard deviation of per pixel sensor noise
+  glm::vec2 Noise = glm::vec2(0.0f, 0.02f);
+  // Blur radius in pixels
+  glm::vec2 Blur = glm::vec2(0.0f, 1.0f);
+  // Exposure in stops
+  glm::vec2 Exposure = glm::vec2(-0.3f, 0.3f);
+  glm::vec2 Dim = glm::vec2(0.0f, 0.0f);
+
+  json ToJson() const;
+  void FromJson(const json &j);
+};
+
+// Samples lighting, material and post effect parameters per rendered view.
+// Everything ends up in one RandomizationUniforms upload, shaders never
+// change.
+class DomainRandomizer {
+public:
+  // Every value is drawn from rng, the same stream gives the same view
+  RandomizationUniforms Sample(Random::Stream &rng) const;
+  // Matches the fixed lighting used before randomization, for previews
+  static RandomizationUniforms Neutral(float dim);
+
+  bool LoadJson(const std::string &path);
+  void SaveJson(const std::string &path) const;
+
+  const RandomizationSettings &GetSettings() const { return mSettings; }
+  RandomizationSettings &ModifySettings() { return mSettings; }
+
+private:
+  RandomizationSettings mSettings;
+};
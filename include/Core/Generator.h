@@ -1,51 +1,108 @@
 #pragma once
 
+#include "Core/ImageWriter.h"
+#include "Core/PoseWriter.h"
+#include "Core/TarWriter.h"
 #include "Managers/CameraManager.h"
 #include "Managers/ModelManager.h"
+#include "Managers/PhysicsBatch.h"
 #include "Managers/PhysicsManager.h"
+#include "Rendering/Textures/TextureReadback.h"
 
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
 #include <glm/glm.hpp>
+#include <memory>
 #include <string>
-
-enum ViewMode { Color = 0, Segmentation, Count };
+#include <vector>
 
 class Generator {
 public:
   Generator(CameraManager *camMgr, ModelManager *modelMng,
-            PhysicsManager *phyMng, ViewMode *viewMode);
+            PhysicsManager *phyMng);
 
-  void Start(const std::string &outputFolder);
+  // False if the output could not be opened, nothing is started then
+  bool Start(const std::string &outputFolder);
   void Stop();
   void Update();
 
   bool IsRunning() const { return mRunning; }
 
   int &ModifyNumRenders() { return mNumRenders; }
-  float GetProgress() { return float(mRenderId) / float(mNumRenders + 1); }
-  bool NeedSim() {
-    return (mRenderId % mCameraManager->GetCount() == 0 || mRenderId == 0) &&
-           mRenderSubId == 0;
+  // Renders [first, NumRenders) only, for shards of a larger run. Should be
+  // a multiple of the camera count so each scene stays in one shard.
+  int &ModifyFirstRender() { return mFirstRender; }
+  // Physics worlds settled in parallel on worker threads
+  int &ModifyPhysicsWorlds() { return mPhysicsWorlds; }
+  // Every pose and view of a run is a pure function of (seed, scene index)
+  uint64_t &ModifySeed() { return mSeed; }
+  uint64_t GetSeed() const { return mSeed; }
+  // Index of the scene currently applied to the models
+  int64_t GetSceneIndex() const { return mSceneIndex; }
+  PoseFormat &ModifyPoseFormat() { return mPoseFormat; }
+  // Encoder spec per output, "png[:level]", "jpeg[:quality]" or "qoi".
+  // Segmentation needs a lossless 16 bit format.
+  std::string &ModifyColorFormat() { return mColorFormat; }
+  std::string &ModifySegmentationFormat() { return mSegmentationFormat; }
+  // Writes WebDataset tar shards of this size instead of loose files, 0 off
+  int &ModifyTarShardMB() { return mTarShardMB; }
+  // Waits for the next settled scene instead of retrying on the next frame,
+  // for headless runs that have no UI to keep responsive
+  bool &ModifyWaitForPhysics() { return mWaitForPhysics; }
+  ImageWriterStats GetWriterStats() const { return mImageWriter->GetStats(); }
+  float GetProgress() {
+    return std::clamp(float(mRenderId - mFirstRender) /
+                          float(std::max(1, mNumRenders - mFirstRender)),
+                      0.0f, 1.0f);
   }
 
 private:
-  std::string getSubfolder() const;
-  std::string getFileName() const;
-  void saveImage();
-  void saveTransforms();
+  std::string getFileName(int renderId) const;
+  bool applyNextScene();
+  void saveViews();
+  // Called from the image writer threads
+  void addTarMember(const std::string &name, std::vector<unsigned char> data);
+  std::shared_ptr<const ImageEncoder>
+  createEncoder(const std::string &spec, int channels, int bytesPerChannel,
+                bool lossless) const;
+  void saveImage(FBO *fbo, int target, const std::string &image,
+                 const std::string &fileName);
+  void saveLabels();
+  void logSimulationStats() const;
 
 private:
   CameraManager *mCameraManager;
   ModelManager *mModelManager;
   PhysicsManager *mPhysicsManager;
-  ViewMode *mViewMode;
+
+  std::unique_ptr<TextureReadback> mReadback;
+  std::unique_ptr<ImageWriter> mImageWriter;
+  std::unique_ptr<PhysicsBatch> mPhysicsBatch;
+  std::unique_ptr<PoseWriter> mPoseWriter;
+  PoseFormat mPoseFormat = PoseFormat::NDJson;
+  std::unique_ptr<TarWriter> mTarWriter;
+  int mTarShardMB = 0;
+  bool mWaitForPhysics = false;
+  std::string mPoseLine;
+  std::string mColorFormat = "png";
+  std::string mSegmentationFormat = "png";
+  std::shared_ptr<const ImageEncoder> mColorEncoder;
+  std::shared_ptr<const ImageEncoder> mSegmentationEncoder;
 
   std::string mOutputFolder;
 
   int mRenderId = 0;
-  int mRenderSubId = 0;
+  int64_t mSceneIndex = -1;
+  uint64_t mSeed;
   int mNumRenders = 10;
+  int mFirstRender = 0;
+  int mPhysicsWorlds = ThreadPool::DefaultThreadCount();
+  bool mSceneApplied = false;
+  std::vector<int> mStepsToRest;
+  std::vector<int> mStopReasons;
   bool mRunning = false;
 
   std::chrono::high_resolution_clock::time_point mStartTime;
+  uint64_t mTraceStart = 0;
 };
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Core/Context.h"
+#include "Core/ShardQueue.h"
+#include "Core/Viewport.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct HeadlessSettings {
+  std::string OutputFolder;
+  std::string Resolution = "480p";
+  std::string RandomizationPath;
+  int NumRenders = 10;
+  int PhysicsWorlds = 0; // 0 keeps the generator default
+  TextureCompression Compression = TextureCompression::None;
+  PoseFormat Poses = PoseFormat::NDJson;
+  int TarShardMB = 0; // 0 writes loose files
+  std::string ColorFormat = "png";
+  std::string SegmentationFormat = "png";
+  int TextureBudgetMB = 0; // 0 keeps every texture
+  std::string Seed; // Empty draws a fresh one
+  // Sharded runs: the coordinator splits the renders into shards of
+  // ShardSize and starts Workers local processes, workers join its queue
+  int ShardSize = 0;
+  int Workers = 0; // 0 renders every shard in the coordinator
+  bool Worker = false;
+  std::string Executable;
+  std::vector<std::string> Args;
+  // Benchmark: every resolution unless listed, report also printed to stdout
+  std::string ReportPath;
+  std::vector<std::string> Resolutions;
+  std::vector<std::string> Cameras;
+  std::vector<std::string> Models;
+
+  static HeadlessSettings Parse(int argc, char **argv);
+};
+
+// Runs the generator on an offscreen context without the ImGui frame loop
+class HeadlessApplication {
+public:
+  HeadlessApplication(const HeadlessSettings &settings);
+
+  int Run();
+  // Renders NumRenders images at each resolution and reports the per stage
+  // timings as json
+  int RunBenchmark();
+
+private:
+  void loadScene();
+  void configureGenerator();
+  // onFrame runs after every frame, shard workers send their heartbeat.
+  // False if the generator could not start.
+  bool generate(const std::string &folder, int firstRender, int numRenders,
+                const std::function<void()> &onFrame = nullptr);
+  int runCoordinator();
+  // Renders queued shards until none is left
+  int runWorker(ShardQueue &queue);
+  // Same command line with the coordinator flags swapped for --worker
+  std::string getWorkerCommand() const;
+
+private:
+  HeadlessSettings mSettings;
+  std::unique_ptr<Context> mContext;
+  std::unique_ptr<BaseFolders> mBaseFolders;
+  std::unique_ptr<TextureManager> mTextureManager;
+  std::unique_ptr<ExampleLoader> mExampleLoader;
+  std::unique_ptr<Viewport> mViewport;
+};
@@ -9,6 +9,7 @@ struct BaseFolders {
   std::string Example;
   std::string Shaders;
   std::string Resources;
+  std::string Cache;
 };
 
 class IAppMode {
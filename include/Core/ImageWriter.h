@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Rendering/Textures/ImageEncoder.h"
+#include "Rendering/Textures/PixelBuffer.h"
+#include "Utilities/ThreadPool.h"
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+struct ImageWriterStats {
+  int Written = 0;
+  int QueueDepth = 0;
+  int MaxQueueDepth = 0;
+  double AverageLatencyMs = 0.0;
+  double MaxLatencyMs = 0.0;
+};
+
+// Bounded queue of encode/write jobs running on a worker pool. Write takes
+// ownership of the pixels and blocks while the queue is full.
+class ImageWriter {
+public:
+  ImageWriter(int numThreads = ThreadPool::DefaultThreadCount(),
+              size_t maxQueued = 0);
+
+  // Encoded on a worker, PNG at the default level without an encoder
+  void Write(const std::string &path, PixelBuffer pixels,
+             std::shared_ptr<const ImageEncoder> encoder = nullptr);
+  // Encoded images go to the sink instead of a file at path, called from the
+  // worker threads. Empty writes files again.
+  void SetSink(std::function<void(const std::string &path,
+                                  std::vector<unsigned char> data)>
+                   sink) {
+    mSink = std::move(sink);
+  }
+  void Drain();
+
+  ImageWriterStats GetStats() const;
+  void ResetStats();
+  int GetThreadCount() const { return mPool.GetThreadCount(); }
+
+private:
+  void recordWrite(double latencyMs);
+
+private:
+  ThreadPool mPool;
+  std::function<void(const std::string &, std::vector<unsigned char>)> mSink;
+
+  mutable std::mutex mStatsMutex;
+  int mWritten = 0;
+  int mMaxQueueDepth = 0;
+  double mTotalLatencyMs = 0.0;
+  double mMaxLatencyMs = 0.0;
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "Rendering/Models/MeshCache.h"
+#include "Rendering/Models/ModelData.h"
+#include "Managers/TextureManager.h"
+#include "Utilities/ThreadPool.h"
+
+// CPU side result of a load job, ready for the GL upload
+struct LoadedAsset {
+  std::string Path;
+  bool IsModel = false;
+  bool Ok = false;
+  ModelData Data;
+  std::vector<DecodedTexture> Textures;
+};
+
+// Parses models and decodes images on worker threads. Results come back in
+// submission order so model ids do not depend on thread timing.
+class AssetLoader {
+public:
+  AssetLoader(MeshCache *cache, const TextureManager *textureManager,
+              int numThreads = ThreadPool::DefaultThreadCount());
+
+  void SubmitModel(const std::string &path);
+  void SubmitTexture(const std::string &path);
+
+  // Finished assets from the front of the queue, at most maxAssets
+  std::vector<LoadedAsset> Poll(size_t maxAssets);
+  size_t GetPending() const { return mPending.size(); }
+
+private:
+  void submit(std::function<LoadedAsset()> job);
+  // True for the first caller, textures shared by models decode once. A
+  // model polled before the job that claimed its texture streams it through
+  // TextureManager::GetTextureAsync. Claims are released by Poll, so a
+  // texture evicted later can be submitted again.
+  bool claimTexture(const std::string &path);
+  void decodeTexture(const std::string &path, const DecodeOptions &options,
+                     LoadedAsset &asset);
+
+private:
+  MeshCache *mCache = nullptr;
+  const TextureManager *mTextureManager = nullptr;
+  std::deque<std::future<LoadedAsset>> mPending;
+
+  std::mutex mClaimedMutex;
+  std::unordered_set<std::string> mClaimed;
+
+  // Last member, workers are joined before the state above is destroyed
+  ThreadPool mPool;
+};
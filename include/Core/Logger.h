@@ -2,6 +2,8 @@
 
 #include <deque>
 #include <fstream>
+#include <iostream>
+#include <mutex>
 
 enum class LogLevel { INFO = 0, WARN, ERR, DEBUG, SUCCESS, FATAL };
 class Logger {
@@ -18,6 +20,12 @@ public:
   static void Fatal(const std::string &msg) { get().log(msg, LogLevel::FATAL); }
 
   static void ShowLogs() { get().showLogsInternal(); }
+  // Console stream of the log lines, stdout by default. Tools that print
+  // their result to stdout send the log to std::cerr.
+  static void SetConsole(std::ostream &console) {
+    std::lock_guard<std::mutex> lock(get().mMutex);
+    get().mConsole = &console;
+  }
 
 private:
   Logger();
@@ -38,4 +46,7 @@ private:
   static constexpr size_t MAX_LOGS = 50;
   std::deque<std::pair<LogLevel, std::string>> mLogs;
   std::ofstream mLogFile;
+  std::ostream *mConsole = &std::cout;
+  // Worker threads log too
+  std::mutex mMutex;
 };
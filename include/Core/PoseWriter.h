@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Core/Camera/CameraParameters.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <reactphysics3d/reactphysics3d.h>
+#include <string>
+#include <vector>
+
+// Json: one pretty printed file per render under poses/
+// NDJson: one line per render in poses.ndjson
+// Binary: fixed size records in poses.bin after a header describing them
+enum class PoseFormat { Json, NDJson, Binary };
+
+// Appends the body and camera poses of every render to one stream per run.
+// Records are buffered and flushed to disk every syncEvery renders, so a
+// crash loses at most one batch.
+class PoseWriter {
+public:
+  static constexpr uint32_t Version = 1;
+
+  PoseWriter(PoseFormat format, size_t syncEvery = 256);
+  ~PoseWriter();
+
+  bool Open(const std::string &outputFolder, int bodyCount);
+  void Write(int renderId, const std::string &fileName,
+             const CameraParameters &camera,
+             const std::vector<reactphysics3d::RigidBody *> &bodies);
+  void Close();
+
+  static bool Parse(const std::string &name, PoseFormat &format);
+  // One compact json object and a newline, the ndjson line of a render
+  static void
+  FormatLine(int renderId, const CameraParameters &camera,
+             const std::vector<reactphysics3d::RigidBody *> &bodies,
+             std::string &line);
+  // Bytes per binary record for bodyCount bodies
+  static size_t GetRecordSize(int bodyCount);
+
+private:
+  void writeJson(const std::string &fileName, const CameraParameters &camera,
+                 const std::vector<reactphysics3d::RigidBody *> &bodies);
+  void writeNDJson(int renderId, const CameraParameters &camera,
+                   const std::vector<reactphysics3d::RigidBody *> &bodies);
+  void writeBinary(int renderId, const CameraParameters &camera,
+                   const std::vector<reactphysics3d::RigidBody *> &bodies);
+  void writeHeader();
+  void sync();
+
+private:
+  PoseFormat mFormat;
+  size_t mSyncEvery;
+  std::string mOutputFolder;
+  int mBodyCount = 0;
+  FILE *mFile = nullptr;
+  size_t mUnsynced = 0;
+  // Reused between records so writing does not allocate
+  std::vector<unsigned char> mRecord;
+  std::string mLine;
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Renders [Begin, End) of a run, written to their own shard folder
+struct ShardRange {
+  int Id = 0;
+  int Begin = 0;
+  int End = 0;
+};
+
+// File based work queue shared by the processes of a sharded run, laid out
+// under the output folder as queue/{pending,claimed,done}/<id>. A shard is
+// claimed by renaming its file out of pending/, the rename is atomic so two
+// workers never get the same shard, also on other nodes sharing the folder.
+// Claims hold the host and pid of their worker, which refreshes the file's
+// modification time while it renders.
+class ShardQueue {
+public:
+  // Claims untouched for longer are taken to belong to a dead worker. Far
+  // above the heartbeat so clock skew between nodes does not matter.
+  static constexpr int StaleSeconds = 180;
+  static constexpr int HeartbeatSeconds = 10;
+
+  ShardQueue(const std::string &outputFolder);
+
+  // Splits [0, numRenders) into shards of shardSize renders. shardSize is
+  // rounded up to a multiple of align so a scene never spans two shards.
+  bool Create(int numRenders, int shardSize, int align, uint64_t seed);
+  // Reads the run written by Create, workers call this before claiming
+  bool Load();
+
+  bool Claim(ShardRange &shard);
+  // Marks the claim as alive, cheap enough to call every frame
+  void Heartbeat(const ShardRange &shard);
+  void Complete(const ShardRange &shard);
+  // Returns claims without a heartbeat for staleSeconds to pending, their
+  // workers exited or crashed. Live claims, also of other nodes, stay.
+  int Requeue(int staleSeconds = StaleSeconds);
+  // Shards claimed by workers that are still alive
+  int GetClaimedCount() const;
+  bool IsFinished() const;
+
+  // Lists every completed shard and copies the shared label files to the
+  // output folder
+  bool WriteManifest() const;
+
+  std::string GetShardFolder(int id) const;
+  uint64_t GetSeed() const { return mSeed; }
+  int GetNumRenders() const { return mNumRenders; }
+
+private:
+  std::string getEntryPath(const std::string &state, int id) const;
+  std::vector<ShardRange> list(const std::string &state) const;
+  void touch(const std::string &path) const;
+
+private:
+  std::string mOutputFolder;
+  std::string mQueueFolder;
+  uint64_t mSeed = 0;
+  int mNumRenders = 0;
+  int mShardSize = 0;
+  std::chrono::steady_clock::time_point mLastHeartbeat;
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Streams samples into WebDataset style tar shards data-<n>.tar. The parts
+// of a sample (<key>.color.png, <key>.pose.json, ...) are held back until
+// all partsPerSample arrived and then written next to each other, a new
+// shard starts once the current one reaches shardBytes. Close writes
+// index.json with every shard and the offset of every sample.
+class TarWriter {
+public:
+  TarWriter(const std::string &folder, size_t shardBytes, int partsPerSample);
+  ~TarWriter();
+
+  // Thread safe, part is the name after the key, e.g. "color.png"
+  void Add(const std::string &key, const std::string &part,
+           std::vector<unsigned char> data);
+  void Close();
+
+private:
+  struct Part {
+    std::string Name;
+    std::vector<unsigned char> Data;
+  };
+  struct IndexEntry {
+    std::string Key;
+    int Shard = 0;
+    uint64_t Offset = 0;
+  };
+
+  void writeSample(const std::string &key, std::vector<Part> &parts);
+  bool openShard();
+  void closeShard();
+  void writeMember(const std::string &name,
+                   const std::vector<unsigned char> &data);
+  void writeIndex() const;
+
+private:
+  std::string mFolder;
+  size_t mShardBytes;
+  int mPartsPerSample;
+
+  std::mutex mMutex;
+  std::map<std::string, std::vector<Part>> mPending;
+  FILE *mFile = nullptr;
+  int mShard = -1;
+  uint64_t mOffset = 0;
+  std::vector<uint64_t> mShardSizes;
+  std::vector<int> mShardSamples;
+  std::vector<IndexEntry> mIndex;
+  bool mClosed = false;
+};
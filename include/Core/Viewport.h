@@ -9,8 +9,10 @@
 #include <vector>
 
 #include "Core/Camera/Camera.h"
+#include "Core/DomainRandomizer.h"
 #include "Core/Generator.h"
 #include "Core/IAppMode.h"
+#include "Core/Loader/AssetLoader.h"
 #include "Core/Loader/ExampleLoader.h"
 
 #include "Rendering/Buffers/FBO.h"
@@ -22,6 +24,12 @@
 #include "Managers/PhysicsManager.h"
 #include "Managers/TextureManager.h"
 
+enum ViewMode {
+  Color = TargetColor,
+  Segmentation = TargetSegmentation,
+  Count
+};
+
 class Viewport : public IAppMode {
 public:
   Viewport(BaseFolders *folders);
@@ -33,9 +41,29 @@ public:
   void Render() override;
   void RenderUI() override;
 
-  void SetTextureManager(TextureManager *tm) { mTextureManager = tm; }
+  void SetTextureManager(TextureManager *tm);
   void SetExampleLoader(ExampleLoader *el) { mExampleLoader = el; }
 
+  // Headless interface, drives the scene without any ImGui calls
+  void UpdateHeadless();
+  void QueueCamera(const std::string &path) { mCameraLoadingQueue.push(path); }
+  void QueueModel(const std::string &path) { mModelLoadingQueue.push(path); }
+  void LoadExample();
+  bool IsLoading() const {
+    return !mCameraLoadingQueue.empty() || !mModelLoadingQueue.empty() ||
+           mAssetLoader->GetPending() > 0 || mTextureManager->GetPending() > 0;
+  }
+  bool SelectResolution(const std::string &name);
+  const std::vector<std::string> &GetResolutionNames() const {
+    return mResolutionNames;
+  }
+  const std::vector<int> &GetResolutionHeights() const {
+    return mResolutionHeights;
+  }
+  Generator *GetGenerator() { return mGenerator.get(); }
+  DomainRandomizer *GetRandomizer() { return mRandomizer.get(); }
+  int GetCameraCount() const { return mCameraManager->GetCount(); }
+
 private:
   void handleMain();
   void updateMain(const ImVec2 &windowSize);
@@ -45,18 +73,23 @@ private:
   void handleDebug();
 
   void handleResolutionChange();
+  void setResolution(int id);
+
+  void updateScene();
+  void renderCamera();
+  void renderAllCameras();
 
   void handleOpenParams();
   void handleOpenModel();
 
-  void addModel(const std::string &modelPath);
+  void addModel(std::unique_ptr<Model> model);
   void removeModel();
 
   void removeCamera();
   void switchCamFBO();
 
   void handleLoad();
-  void loadExample();
+  void uploadAssets();
 
 private:
   BaseFolders *mBaseFolders = nullptr;
@@ -66,10 +99,13 @@ private:
   std::unique_ptr<ModelManager> mModelManager;
   std::unique_ptr<CameraManager> mCameraManager;
   std::unique_ptr<Quad> mBgQuad;
-  std::unique_ptr<Quad> mDimQuad;
+  std::unique_ptr<Quad> mPostQuad;
+  std::unique_ptr<DomainRandomizer> mRandomizer;
   std::unique_ptr<ViewMode> mViewMode;
   std::unique_ptr<Generator> mGenerator;
   std::unique_ptr<PhysicsManager> mPhysicsManager;
+  std::unique_ptr<MeshCache> mMeshCache;
+  std::unique_ptr<AssetLoader> mAssetLoader;
 
   ImVec2 mImageOffset;
   glm::vec2 mImageSize = glm::vec2(0);
@@ -80,8 +116,7 @@ private:
   TextureManager *mTextureManager = nullptr;
   Texture *mBgTexture = nullptr;
 
-  float mMaxDim = 0.0f;
-  float mDim = 0.0f;
+  bool mViewsComplete = true;
 
   std::vector<std::string> mResolutionNames = {"480p", "720p", "1080p", "1440p",
                                                "4K"};
@@ -12,13 +12,12 @@ public:
   Model *GetSelectedModel() { return mModels[mSelectedId].get(); }
   Model *GetModel(int id);
   std::vector<std::unique_ptr<Model>> &GetModels() { return mModels; }
-  const std::vector<glm::vec3> &GetSegmentedColors() const {
-    return mModelSegmentedColors;
-  }
   const int GetCount() const { return static_cast<int>(mModels.size()); }
   const std::vector<std::string> &GetModelNames() const { return mModelNames; }
 
   const int GetSelectedId() const { return mSelectedId; }
+  // Bumped whenever the model list changes
+  const int GetRevision() const { return mRevision; }
 
 private:
   bool isIdValid(int id);
@@ -27,6 +26,5 @@ private:
   std::vector<std::unique_ptr<Model>> mModels;
   std::vector<std::string> mModelNames;
   int mSelectedId = -1;
-
-  std::vector<glm::vec3> mModelSegmentedColors;
+  int mRevision = 0;
 };
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Managers/PhysicsManager.h"
+#include "Utilities/ThreadPool.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct SettledScene {
+  int64_t Index = 0;
+  int World = 0;
+  SimulationResult Result;
+};
+
+// Runs independent copies of the scene's physics world on a worker pool.
+// Worlds claim scene indices in turn, drop their bodies from poses seeded by
+// (seed, index) and push the settled transforms into a bounded queue. The
+// renderer pops scenes in index order, so the output does not depend on the
+// number of worlds or on which one finished first.
+class PhysicsBatch {
+public:
+  PhysicsBatch(int numWorlds, uint64_t seed, size_t maxQueued = 0);
+  ~PhysicsBatch();
+
+  // Rebuilds the body set of every world, must be called while stopped
+  void SetBodies(const std::vector<std::unique_ptr<Model>> &models,
+                 float spawningSpace);
+
+  // Scenes are numbered from firstIndex on
+  void Start(int64_t firstIndex = 0);
+  void Stop();
+
+  // Blocks until the next scene in index order is settled, false if stopped
+  bool Pop(SettledScene &scene);
+  // Returns false at once while the next scene is still settling
+  bool TryPop(SettledScene &scene);
+
+  bool IsRunning() const { return mRunning; }
+  int GetWorldCount() const { return static_cast<int>(mWorlds.size()); }
+  size_t GetQueued() const;
+
+private:
+  void runWorld(int id);
+  // Takes the scene at mNextPop, with the lock held
+  void pop(std::unique_lock<std::mutex> &lock,
+           std::map<int64_t, SettledScene>::iterator next,
+           SettledScene &scene);
+
+private:
+  std::vector<std::unique_ptr<PhysicsManager>> mWorlds;
+  std::unique_ptr<ThreadPool> mPool;
+
+  // Settled scenes by index, workers only push within mMaxQueued of the next
+  // index to pop so the one it waits on always has room
+  std::map<int64_t, SettledScene> mQueue;
+  int64_t mNextPop = 0;
+  std::atomic<int64_t> mNextIndex{0};
+  uint64_t mSeed;
+  size_t mMaxQueued;
+  mutable std::mutex mMutex;
+  std::condition_variable mSceneAvailable;
+  std::condition_variable mSpaceAvailable;
+  std::atomic<bool> mRunning{false};
+};
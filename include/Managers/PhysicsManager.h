@@ -1,10 +1,22 @@
 #pragma once
 
+#include "Managers/SettlingController.h"
 #include "Rendering/Models/Model.h"
+#include "Utilities/Random.h"
 
 #include <glm/glm.hpp>
 #include <reactphysics3d/reactphysics3d.h>
 
+// Sleep: rp3d put every body to sleep, Settled: the settling controller
+// declared rest earlier, StepCap: maxSteps was reached
+enum class StopReason { Sleep, Settled, StepCap };
+
+struct SimulationResult {
+  std::vector<reactphysics3d::Transform> Transforms;
+  int Steps = 0;
+  StopReason Reason = StopReason::StepCap;
+};
+
 class PhysicsManager {
 public:
   PhysicsManager();
@@ -14,6 +26,15 @@ public:
 
   void Update(std::vector<std::unique_ptr<Model>> &models);
 
+  // Drops the bodies from poses drawn from rng and steps in a tight loop
+  // until every body rests or maxSteps is reached. The same stream always
+  // settles to the same transforms. Safe to call from a worker thread, each
+  // manager owns its world.
+  SimulationResult SimulateToRest(int maxSteps, Random::Stream rng);
+  std::vector<reactphysics3d::Transform> GetTransforms() const;
+  void SetTransforms(const std::vector<reactphysics3d::Transform> &transforms,
+                     std::vector<std::unique_ptr<Model>> &models);
+
   void Simulate() {
     mSimulating = true;
     mSimulationFrame = 0;
@@ -23,6 +44,7 @@ public:
   float &ModSpawningSpace() { return mSpawningSpace; }
 
   bool IsSimulating() { return mSimulating; }
+  const int GetMaxSteps() const { return mSimulatingFrames; }
 
   const int GetBodyCount() const { return static_cast<int>(mBodies.size()); }
   const std::vector<reactphysics3d::RigidBody *> GetBodies() const {
@@ -31,7 +53,10 @@ public:
 
 private:
   void addGroundPlane();
-  void randomizeTransforms();
+  void randomizeTransforms(Random::Stream &rng);
+  // Returns true once every body sleeps
+  bool step();
+  void syncModels(std::vector<std::unique_ptr<Model>> &models) const;
   reactphysics3d::Transform defaultTransform() const;
   reactphysics3d::RigidBody *
   createRigidBody(reactphysics3d::BodyType type,
@@ -39,6 +64,11 @@ private:
                   bool trackInBodies = true);
   void attachBoxCollider(reactphysics3d::RigidBody *body,
                          const reactphysics3d::Vector3 &halfExtents);
+  // One convex hull per mesh, false if none could be built
+  bool attachConvexColliders(reactphysics3d::RigidBody *body, Model *model);
+  const std::vector<std::vector<float>> &getHullPoints(Model *model);
+  reactphysics3d::ConvexMesh *
+  createConvexMesh(const std::vector<float> &points);
 
 private:
   std::unique_ptr<reactphysics3d::PhysicsCommon> mPhysicsCommon;
@@ -46,6 +76,7 @@ private:
                   std::function<void(reactphysics3d::PhysicsWorld *)>>
       mPhysicsWorld;
   std::vector<reactphysics3d::RigidBody *> mBodies;
+  SettlingController mSettling;
   reactphysics3d::RigidBody *mGround;
   bool mSimulating = false;
   int mSimulatingFrames = 1000;
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <reactphysics3d/reactphysics3d.h>
+#include <vector>
+
+struct SettlingSettings {
+  // Steps a body has to stay below both speeds to count as resting
+  int Window = 20;
+  float LinearSpeed = 0.02f;
+  float AngularSpeed = 0.05f;
+  // Kinetic energy per unit mass below which contacts count as stable
+  float StableEnergy = 0.005f;
+  int StableSteps = 10;
+  int MaxIterations = 20;
+  int MinIterations = 6;
+};
+
+// Declares a drop at rest before the bodies fall asleep and lowers the
+// velocity solver iterations once the contacts have stopped changing
+class SettlingController {
+public:
+  SettlingController(const SettlingSettings &settings = SettlingSettings());
+
+  void Reset(reactphysics3d::PhysicsWorld *world, size_t numBodies);
+  // Call after every world step, returns true once every body is resting
+  bool Update(reactphysics3d::PhysicsWorld *world,
+              const std::vector<reactphysics3d::RigidBody *> &bodies);
+
+  const SettlingSettings &GetSettings() const { return mSettings; }
+  float GetKineticEnergy() const { return mEnergy; }
+  int GetIterations() const { return mIterations; }
+
+private:
+  void setIterations(reactphysics3d::PhysicsWorld *world, int iterations);
+
+private:
+  SettlingSettings mSettings;
+  std::vector<int> mSlowSteps;
+  int mStableSteps = 0;
+  int mIterations = 0;
+  float mEnergy = 0.0f;
+};
@@ -2,31 +2,119 @@
 
 #include "Core/Logger.h"
 #include "Rendering/Textures/Texture.h"
+#include "Rendering/Textures/TextureCache.h"
+#include "Rendering/Textures/TextureUpload.h"
+#include "Utilities/ThreadPool.h"
+
+#include <atomic>
+#include <list>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+struct TextureStats {
+  size_t Hits = 0;
+  size_t Misses = 0;
+  size_t Evictions = 0;
+  size_t Bytes = 0;
+  size_t Count = 0;
+};
+
+// Target height and compression a decode is made for, copied on the GL
+// thread when the job is submitted
+struct DecodeOptions {
+  int TargetHeight = 0;
+  TextureCompression Compression = TextureCompression::None;
+};
+
 class TextureManager {
 public:
-  // Load or retrieve a texture
-  Texture *GetTexture(const std::string &path) {
-    // Check if the texture is already loaded
-    auto it = mTextureMap.find(path);
-    if (it != mTextureMap.end()) {
-      // Logger::Debug("Texture already loaded: " + path);
-      return mTextures[it->second].get();
-    }
-
-    // Load the texture if not already loaded
-    Logger::Info("TextureManager: Loading and caching new texture: " + path);
-    auto texture = std::make_unique<Texture>(path);
-    Texture *rawTexture = texture.get();
-    mTextures.push_back(std::move(texture));
-    mTextureMap[path] = mTextures.size() - 1;
-    return rawTexture;
+  TextureManager(int decodeThreads = 2);
+
+  // Load or retrieve a texture, decodes and uploads on the calling thread
+  Texture *GetTexture(const std::string &path);
+  // Returns a placeholder at once, the image decodes on the pool and is
+  // swapped into the same Texture by Update
+  Texture *GetTextureAsync(const std::string &path);
+
+  bool Has(const std::string &path) const {
+    return mTextures.find(path) != mTextures.end();
+  }
+
+  // Upload an image decoded off the GL thread, fills a pending placeholder
+  Texture *AddTexture(const DecodedTexture &texture);
+
+  // Reads the texture cache or decodes, downscales and compresses the source.
+  // Thread safe, used by the pool and by AssetLoader. Take the options with
+  // GetDecodeOptions before handing the job to another thread.
+  bool Decode(const std::string &path, const DecodeOptions &options,
+              DecodedTexture &texture) const;
+  DecodeOptions GetDecodeOptions() const {
+    return {mTargetHeight, mCompression};
   }
 
+  // Uploads finished decodes and evicts over the budget, call once per frame
+  // on the GL thread. Pointers from Get stay valid until the next Update
+  // unless the texture is pinned.
+  void Update();
+  // Textures still showing their placeholder
+  size_t GetPending() const { return mStreaming.size(); }
+
+  void SetUploadBudget(size_t bytesPerFrame) { mUploadBudget = bytesPerFrame; }
+  // Least recently used unpinned textures are evicted above this many GPU
+  // bytes, 0 keeps everything
+  void SetMemoryBudget(size_t bytes) { mMemoryBudget = bytes; }
+  const TextureStats &GetStats() const { return mStats; }
+
+  void SetCache(const std::string &folder) {
+    mCache = std::make_unique<TextureCache>(folder);
+  }
+  // Larger images are downscaled to this height, 0 keeps the source size.
+  // Only affects textures decoded afterwards, see Invalidate.
+  void SetTargetHeight(int height) { mTargetHeight = height; }
+  // Decodes every resident texture again at the current target height. The
+  // old images stay bound until the new ones are uploaded in place.
+  void Invalidate();
+  void SetCompression(TextureCompression mode) { mCompression = mode; }
+
+private:
+  // Marks a hit as most recently used, nullptr on a miss
+  Texture *find(const std::string &path);
+  Texture *insert(const std::string &path, std::unique_ptr<Texture> texture);
+  Texture *insertPlaceholder(const std::string &path);
+  // Decodes on the pool, the result is uploaded by Update
+  void stream(const std::string &path);
+  void upload(const DecodedTexture &texture);
+  void evict();
+
 private:
-  std::vector<std::unique_ptr<Texture>> mTextures;
-  std::unordered_map<std::string, size_t> mTextureMap;
+  struct Entry {
+    std::unique_ptr<Texture> Tex;
+    std::list<std::string>::iterator Recent;
+  };
+  std::unordered_map<std::string, Entry> mTextures;
+  // Front is the most recently used
+  std::list<std::string> mRecent;
+  size_t mMemoryBudget = 0;
+  TextureStats mStats;
+
+  std::unique_ptr<TextureUpload> mUpload;
+  std::unordered_set<std::string> mStreaming;
+  size_t mUploadBudget = 64 * 1024 * 1024;
+
+  std::unique_ptr<TextureCache> mCache;
+  // GL thread only, decode jobs get a copy in DecodeOptions
+  int mTargetHeight = 0;
+  TextureCompression mCompression = TextureCompression::None;
+
+  std::mutex mDecodedMutex;
+  std::vector<DecodedTexture> mDecoded;
+  // Bumped by Invalidate, decodes started before are dropped
+  std::atomic<uint64_t> mGeneration{0};
+
+  // Last member, workers are joined before the state above is destroyed
+  ThreadPool mPool;
 };
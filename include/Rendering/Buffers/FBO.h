@@ -5,14 +5,16 @@
 #include "Rendering/Textures/Texture.h"
 
 #include <memory>
+#include <vector>
 
 class FBO {
 public:
   GLuint ID = 0;
-  std::unique_ptr<Texture> ColorTexture;
+  std::vector<std::unique_ptr<Texture>> ColorTextures;
   GLuint DepthStencilID = 0;
 
-  FBO(int width, int height);
+  FBO(int width, int height,
+      const std::vector<TextureFormat> &formats = {TextureFormat::RGBA8()});
 
   void Bind() const;
   void Unbind() const;
@@ -21,11 +23,20 @@ public:
   void BindDraw() const;
   void Delete();
 
+  // Select color attachments written by draws and blits, FBO must be bound
+  void DrawToAll() const;
+  void DrawTo(int attachment) const;
+
   void Resize(int newWidth, int newHeight);
 
+  Texture *GetColorTexture(int attachment = 0) const;
+
 private:
   void recreateFramebuffer(int width, int height);
-  void createColorAttachment(int width, int height);
+  void createColorAttachments(int width, int height);
   void createDepthStencilAttachment(int width, int height);
   void checkComplete() const;
+
+private:
+  std::vector<TextureFormat> mFormats;
 };
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// Pixel buffer, persistently mapped so the CPU can use it in place. Pack
+// buffers are read after a readback, unpack buffers are written before an
+// upload.
+class PBO {
+public:
+  GLuint ID = 0;
+
+  PBO(GLsizeiptr size, GLenum target = GL_PIXEL_PACK_BUFFER)
+      : mSize(size), mTarget(target) {
+    const GLbitfield access =
+        target == GL_PIXEL_PACK_BUFFER ? GL_MAP_READ_BIT : GL_MAP_WRITE_BIT;
+    const GLbitfield flags =
+        access | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &ID);
+    Bind();
+    glBufferStorage(mTarget, size, nullptr, flags);
+    mMapped = static_cast<unsigned char *>(
+        glMapBufferRange(mTarget, 0, size, flags));
+    Unbind();
+  }
+
+  void Bind() const { glBindBuffer(mTarget, ID); }
+  void Unbind() const { glBindBuffer(mTarget, 0); }
+  void Delete() { glDeleteBuffers(1, &ID); }
+
+  GLsizeiptr GetSize() const { return mSize; }
+  const unsigned char *GetMapped() const { return mMapped; }
+  unsigned char *GetMapped() { return mMapped; }
+
+private:
+  GLsizeiptr mSize = 0;
+  GLenum mTarget = GL_PIXEL_PACK_BUFFER;
+  unsigned char *mMapped = nullptr;
+};
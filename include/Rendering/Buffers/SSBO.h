@@ -0,0 +1,33 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// Shader storage buffer attached to a fixed binding point, storage grows to
+// fit the largest upload
+class SSBO {
+public:
+  GLuint ID = 0;
+
+  SSBO(GLuint binding) : mBinding(binding) { glGenBuffers(1, &ID); }
+
+  void Update(const void *data, GLsizeiptr size) {
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, ID);
+    if (size > mSize) {
+      glBufferData(GL_SHADER_STORAGE_BUFFER, size, data, GL_DYNAMIC_DRAW);
+      mSize = size;
+    } else if (size > 0) {
+      glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, size, data);
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+  }
+  void BindBase() const {
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, mBinding, ID);
+  }
+  void Delete() { glDeleteBuffers(1, &ID); }
+
+  GLsizeiptr GetSize() const { return mSize; }
+
+private:
+  GLsizeiptr mSize = 0;
+  GLuint mBinding = 0;
+};
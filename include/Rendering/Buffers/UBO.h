@@ -0,0 +1,31 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// Uniform buffer attached to a fixed binding point shared by all programs
+class UBO {
+public:
+  GLuint ID = 0;
+
+  UBO(GLsizeiptr size, GLuint binding) : mSize(size), mBinding(binding) {
+    glGenBuffers(1, &ID);
+    glBindBuffer(GL_UNIFORM_BUFFER, ID);
+    glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+  }
+
+  void Update(const void *data, GLsizeiptr size, GLintptr offset = 0) const {
+    glBindBuffer(GL_UNIFORM_BUFFER, ID);
+    glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+  }
+  void BindBase() const { glBindBufferBase(GL_UNIFORM_BUFFER, mBinding, ID); }
+  void Delete() { glDeleteBuffers(1, &ID); }
+
+  GLsizeiptr GetSize() const { return mSize; }
+  GLuint GetBinding() const { return mBinding; }
+
+private:
+  GLsizeiptr mSize = 0;
+  GLuint mBinding = 0;
+};
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "Rendering/Models/ModelData.h"
+
+#include <cstdint>
+#include <string>
+
+// Binary cache of parsed models, one file per source path. Entries are
+// validated against the source size, modification time and content hash,
+// and read through a memory mapping without any parsing.
+class MeshCache {
+public:
+  MeshCache(const std::string &folder);
+
+  bool Load(const std::string &path, ModelData &data) const;
+  bool Save(const std::string &path, const ModelData &data) const;
+
+  static constexpr uint32_t Version = 1;
+
+private:
+  std::string cachePath(const std::string &path) const;
+
+private:
+  std::string mFolder;
+};
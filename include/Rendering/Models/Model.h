@@ -7,36 +7,48 @@
 #include <vector>
 
 #include "Rendering/Models/Mesh.h"
+#include "Rendering/Models/MeshCache.h"
+#include "Rendering/Models/ModelData.h"
 
 class Model {
 public:
-  Model(const std::string &path, TextureManager *texMng);
+  Model(const std::string &path, TextureManager *texMng,
+        MeshCache *cache = nullptr);
+  // Builds from data parsed on a worker thread, see AssetLoader
+  Model(const std::string &path, ModelData data, TextureManager *texMng);
+
+  // Parses with Assimp without touching GL, safe on worker threads
+  static bool Parse(const std::string &path, ModelData &data);
+  // Reads the mesh cache first and refreshes it after a miss
+  static bool Load(const std::string &path, ModelData &data, MeshCache *cache);
 
   const std::string &GetPath() { return mPath; }
   std::vector<Mesh> &GetMeshes() { return mMeshes; }
   const glm::vec3 &GetMaxVert() const { return mMaxVert; }
   const glm::vec3 &GetMinVert() const { return mMinVert; }
-  void Draw(Shader &shader, Camera &camera, const glm::vec3 &color);
 
   void SetModelMatrix(const glm::mat4 &model) { mModel = model; }
   glm::mat4 GetModelMatrix() const { return mModel; }
 
 private:
-  void calculateBoundingBox();
+  void build(ModelData &data);
 
-  void loadModel(const std::string &path);
-  void processNode(aiNode *node, const aiScene *scene);
-  Mesh processMesh(aiMesh *mesh, const aiScene *scene);
-  std::vector<std::string> loadMaterialTextures(aiMaterial *mat,
-                                                aiTextureType type);
+  static void calculateBoundingBox(ModelData &data);
+  static void processNode(aiNode *node, const aiScene *scene,
+                          const std::string &directory, ModelData &data);
+  static MeshData processMesh(aiMesh *mesh, const aiScene *scene,
+                              const std::string &directory);
+  static std::vector<std::string>
+  loadMaterialTextures(aiMaterial *mat, aiTextureType type,
+                       const std::string &directory);
 
 private:
   glm::mat4 mModel = glm::mat4(1.0f);
   std::vector<Mesh> mMeshes;
 
   std::string mPath;
-  glm::vec3 mMinVert;
-  glm::vec3 mMaxVert;
+  glm::vec3 mMinVert = glm::vec3(0.0f);
+  glm::vec3 mMaxVert = glm::vec3(0.0f);
 
   TextureManager *mTextureManager = nullptr;
 };
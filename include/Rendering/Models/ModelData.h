@@ -0,0 +1,20 @@
+#pragma once
+
+#include "Rendering/Buffers/VBO.h"
+
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+// CPU side result of parsing a model file, no GL objects involved
+struct MeshData {
+  std::vector<Vertex> Vertices;
+  std::vector<GLuint> Indices;
+  std::vector<std::string> Textures;
+};
+
+struct ModelData {
+  std::vector<MeshData> Meshes;
+  glm::vec3 MinVert = glm::vec3(0.0f);
+  glm::vec3 MaxVert = glm::vec3(0.0f);
+};
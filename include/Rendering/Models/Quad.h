@@ -19,5 +19,5 @@ public:
 private:
   std::unique_ptr<VAO> mVAO;
   std::unique_ptr<VBO<float>> mVBO;
-  Texture *mTexture;
+  Texture *mTexture = nullptr;
 };
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Rendering/Buffers/EBO.h"
+#include "Rendering/Buffers/SSBO.h"
+#include "Rendering/Buffers/VAO.h"
+#include "Rendering/Models/Model.h"
+
+#include <memory>
+#include <vector>
+
+// Layout fixed by glMultiDrawElementsIndirect
+struct DrawCommand {
+  GLuint Count;
+  GLuint InstanceCount;
+  GLuint FirstIndex;
+  GLint BaseVertex;
+  GLuint BaseInstance;
+};
+
+// std430 layout of DrawData in colorVert.glsl, indexed by gl_BaseInstance
+struct DrawData {
+  GLuint ModelIndex;
+  GLuint InstanceId;
+  GLuint HasTexture;
+  GLuint Padding;
+};
+
+// Draws that share a texture, issued with one multi draw call
+struct DrawBatch {
+  Texture *Tex = nullptr;
+  GLsizei First = 0;
+  GLsizei Count = 0;
+};
+
+// Every mesh of every model merged into one vertex and index buffer. Model
+// matrices live in an SSBO, so a frame is one indirect draw per texture.
+class SceneGeometry {
+public:
+  SceneGeometry();
+  ~SceneGeometry();
+
+  // Rebuilds the merged buffers, call whenever models are added or removed
+  void Build(const std::vector<std::unique_ptr<Model>> &models);
+  void UpdateTransforms(const std::vector<std::unique_ptr<Model>> &models);
+  // Expects the scene shader to be active
+  void Draw() const;
+
+  int GetDrawCount() const { return mDrawCount; }
+  int GetBatchCount() const { return static_cast<int>(mBatches.size()); }
+
+private:
+  void release();
+
+private:
+  std::unique_ptr<VAO> mVAO;
+  std::unique_ptr<VBO<Vertex>> mVBO;
+  std::unique_ptr<EBO> mEBO;
+  GLuint mIndirectID = 0;
+  std::unique_ptr<SSBO> mModelMatrices;
+  std::unique_ptr<SSBO> mDrawData;
+
+  std::vector<DrawBatch> mBatches;
+  std::vector<glm::mat4> mMatrices;
+  int mDrawCount = 0;
+};
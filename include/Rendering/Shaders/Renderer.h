@@ -1,26 +1,91 @@
 #pragma once
 
 #include "Core/Camera/Camera.h"
-#include "Core/Generator.h"
 #include "Rendering/Buffers/FBO.h"
+#include "Rendering/Buffers/UBO.h"
 #include "Rendering/Models/Model.h"
 #include "Rendering/Models/Quad.h"
+#include "Rendering/Models/SceneGeometry.h"
 #include "Rendering/Shaders/Shader.h"
 
+#include <cstdint>
 #include <memory>
 
+// Color and instance ids are written in the same geometry pass
+enum RenderTarget { TargetColor = 0, TargetSegmentation, TargetCount };
+
+// std140 layout of CameraBlock in colorVert.glsl, binding 0
+struct CameraUniforms {
+  glm::mat4 CamMatrix;
+  glm::vec4 CamPos;
+};
+
+constexpr int MAX_LIGHTS = 4;
+
+// std140 layout of RandomizationBlock in colorFrag.glsl and postFrag.glsl,
+// binding 1. Directions point towards the light, colors include intensity.
+struct RandomizationUniforms {
+  glm::vec4 LightDirs[MAX_LIGHTS];
+  glm::vec4 LightColors[MAX_LIGHTS];
+  glm::vec4 Ambient;
+  glm::vec4 Tint;
+  int32_t LightCount;
+  float Noise;
+  float Blur;
+  float Exposure;
+  float Dim;
+  uint32_t NoiseSeed;
+  float Padding[2];
+};
+
+// One camera's pass over the shared scene state
+struct RenderView {
+  Camera *Cam = nullptr;
+  FBO *Target = nullptr;
+  Texture *Background = nullptr;
+  RandomizationUniforms Randomization = {};
+};
+
 class Renderer {
 public:
   Renderer(const std::string &shadersPath);
 
-  void Begin(Camera *cam, FBO *fbo, ViewMode *viewMode, Quad *bgQuad);
-  void RenderModel(Camera *cam, FBO *fbo, ViewMode *viewMode, Model *model,
-                   glm::vec3 &color);
-  void End(Quad *dimQuad, float dim, ViewMode *viewMode, FBO *fbo);
+  static std::vector<TextureFormat> TargetFormats() {
+    return {TextureFormat::RGBA8(), TextureFormat::R16UI()};
+  }
+
+  // Rebuilds the merged geometry when the revision changes and uploads the
+  // current model matrices, call once per frame before any pass
+  void UpdateScene(const std::vector<std::unique_ptr<Model>> &models,
+                   int revision);
+
+  // Lighting, material and post effect parameters for the next pass
+  void SetRandomization(const RandomizationUniforms &randomization);
+
+  void Begin(Camera *cam, FBO *fbo, Quad *bgQuad);
+  void RenderScene(Camera *cam, FBO *fbo);
+  // Post effects from the randomization: blur, exposure, dim and noise
+  void End(Quad *postQuad, FBO *fbo);
+
+  // Renders the same model poses into every view back to back
+  void RenderViews(const std::vector<RenderView> &views, Quad *bgQuad,
+                   Quad *postQuad);
+
+  // Colorizes the instance id target for display
+  void RenderSegmentationPreview(FBO *fbo, Quad *quad, int numInstances);
+  Texture *GetSegmentationPreview() const {
+    return mSegmentationPreviewFBO->GetColorTexture();
+  }
 
 private:
   std::unique_ptr<Shader> mRgbShader;
-  std::unique_ptr<Shader> mFlatShader;
   std::unique_ptr<Shader> mQuadShader;
+  std::unique_ptr<Shader> mSegmentationShader;
+  std::unique_ptr<Shader> mPostShader;
+  std::unique_ptr<UBO> mCameraUBO;
+  std::unique_ptr<UBO> mRandomizationUBO;
+  std::unique_ptr<SceneGeometry> mScene;
+  int mSceneRevision = -1;
   std::unique_ptr<FBO> mPostProcessFBO;
+  std::unique_ptr<FBO> mSegmentationPreviewFBO;
 };
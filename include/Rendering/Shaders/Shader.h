@@ -4,6 +4,7 @@
 
 #include <glm/glm.hpp>
 #include <string>
+#include <unordered_map>
 
 class Shader {
 public:
@@ -20,6 +21,7 @@ public:
 
   void SetBool(const std::string &name, bool value) const;
   void SetInt(const std::string &name, const int value) const;
+  void SetUInt(const std::string &name, const unsigned int value) const;
   void SetFloat(const std::string &name, const float value) const;
   void SetVec3(const std::string &name, const glm::vec3 &value) const;
   void SetVec4(const std::string &name, const glm::vec4 &value) const;
@@ -28,7 +30,10 @@ public:
 
 private:
   std::string readShaderFile(const char *filePath);
+  void cacheUniformLocations();
 
 private:
   unsigned int mID;
+  // Resolved once after linking, setters never query GL for locations
+  std::unordered_map<std::string, int> mLocations;
 };
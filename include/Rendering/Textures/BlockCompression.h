@@ -0,0 +1,25 @@
+#pragma once
+
+#include "Rendering/Textures/PixelBuffer.h"
+#include "Rendering/Textures/Texture.h"
+
+#include <string>
+
+// Not part of core GL, every desktop driver exposes it
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+
+enum class TextureCompression { None, BC1, BC7 };
+
+// CPU block encoders for cached textures. BC1 stores RGB at 4 bits per
+// pixel, BC7 (mode 6 only) stores RGBA at 8 bits per pixel with far less
+// banding. Input is 8 bit RGB or RGBA, edge pixels pad partial blocks.
+namespace BlockCompression {
+
+GLenum GetFormat(TextureCompression mode);
+CompressedImage Encode(const PixelBuffer &pixels, TextureCompression mode);
+
+bool Parse(const std::string &name, TextureCompression &mode);
+
+} // namespace BlockCompression
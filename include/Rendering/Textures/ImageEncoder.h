@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Rendering/Textures/PixelBuffer.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// Encodes pixel buffers into an image file in memory. Encoders keep no state
+// between calls, one instance is shared by every writer thread.
+class ImageEncoder {
+public:
+  virtual ~ImageEncoder() = default;
+
+  virtual bool Encode(const PixelBuffer &pixels,
+                      std::vector<unsigned char> &out) const = 0;
+  virtual bool Supports(int channels, int bytesPerChannel) const = 0;
+  virtual bool IsLossless() const = 0;
+  // With the dot, ".png"
+  virtual const char *GetExtension() const = 0;
+
+  // "png[:level]", "jpeg[:quality]" or "qoi", nullptr if unknown
+  static std::unique_ptr<ImageEncoder> Create(const std::string &spec);
+};
+
+// Level 0 stores without compression, 1-4 use a fixed filter and the
+// shortest match search, 5-9 pick the best filter per row and search deeper.
+// 8 matches stb_image_write's default. 8 and 16 bit, 1 to 4 channels.
+class PngEncoder : public ImageEncoder {
+public:
+  PngEncoder(int level = 8);
+
+  bool Encode(const PixelBuffer &pixels,
+              std::vector<unsigned char> &out) const override;
+  bool Supports(int channels, int bytesPerChannel) const override;
+  bool IsLossless() const override { return true; }
+  const char *GetExtension() const override { return ".png"; }
+
+private:
+  int mLevel;
+};
+
+// 8 bit, alpha is dropped
+class JpegEncoder : public ImageEncoder {
+public:
+  JpegEncoder(int quality = 90);
+
+  bool Encode(const PixelBuffer &pixels,
+              std::vector<unsigned char> &out) const override;
+  bool Supports(int channels, int bytesPerChannel) const override;
+  bool IsLossless() const override { return false; }
+  const char *GetExtension() const override { return ".jpg"; }
+
+private:
+  int mQuality;
+};
+
+// Quite OK Image format, lossless and several times faster than PNG at a
+// similar size for rendered frames. 8 bit RGB or RGBA only.
+class QoiEncoder : public ImageEncoder {
+public:
+  bool Encode(const PixelBuffer &pixels,
+              std::vector<unsigned char> &out) const override;
+  bool Supports(int channels, int bytesPerChannel) const override;
+  bool IsLossless() const override { return true; }
+  const char *GetExtension() const override { return ".qoi"; }
+};
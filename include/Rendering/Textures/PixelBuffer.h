@@ -0,0 +1,66 @@
+#pragma once
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+// Move-only image memory, either owned or borrowed from a mapped buffer that
+// is handed back through the release callback once the pixels are consumed
+class PixelBuffer {
+public:
+  PixelBuffer() = default;
+  PixelBuffer(int width, int height, int channels, int bytesPerChannel,
+              std::vector<unsigned char> data)
+      : mWidth(width), mHeight(height), mChannels(channels),
+        mBytesPerChannel(bytesPerChannel), mOwned(std::move(data)) {}
+  PixelBuffer(int width, int height, int channels, int bytesPerChannel,
+              const unsigned char *data, std::function<void()> onRelease)
+      : mWidth(width), mHeight(height), mChannels(channels),
+        mBytesPerChannel(bytesPerChannel), mBorrowed(data),
+        mOnRelease(std::move(onRelease)) {}
+  ~PixelBuffer() { Release(); }
+
+  PixelBuffer(const PixelBuffer &) = delete;
+  PixelBuffer &operator=(const PixelBuffer &) = delete;
+  PixelBuffer(PixelBuffer &&other) noexcept { *this = std::move(other); }
+  PixelBuffer &operator=(PixelBuffer &&other) noexcept {
+    if (this == &other) return *this;
+    Release();
+    mWidth = other.mWidth;
+    mHeight = other.mHeight;
+    mChannels = other.mChannels;
+    mBytesPerChannel = other.mBytesPerChannel;
+    mOwned = std::move(other.mOwned);
+    mBorrowed = other.mBorrowed;
+    mOnRelease = std::move(other.mOnRelease);
+    other.mBorrowed = nullptr;
+    other.mOnRelease = nullptr;
+    return *this;
+  }
+
+  void Release() {
+    if (mOnRelease) mOnRelease();
+    mOnRelease = nullptr;
+    mBorrowed = nullptr;
+    mOwned.clear();
+  }
+
+  const unsigned char *GetData() const {
+    return mBorrowed ? mBorrowed : mOwned.data();
+  }
+  int GetWidth() const { return mWidth; }
+  int GetHeight() const { return mHeight; }
+  int GetChannels() const { return mChannels; }
+  int GetBytesPerChannel() const { return mBytesPerChannel; }
+  int GetStride() const { return mWidth * mChannels * mBytesPerChannel; }
+  size_t GetSize() const { return size_t(GetStride()) * mHeight; }
+
+private:
+  int mWidth = 0;
+  int mHeight = 0;
+  int mChannels = 0;
+  int mBytesPerChannel = 1;
+  std::vector<unsigned char> mOwned;
+  const unsigned char *mBorrowed = nullptr;
+  std::function<void()> mOnRelease;
+};
@@ -3,23 +3,83 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <string>
+
+#include "Rendering/Textures/PixelBuffer.h"
+
 #include <vector>
 
+struct TextureFormat {
+  GLenum InternalFormat = GL_RGBA8;
+  GLenum Format = GL_RGBA;
+  GLenum Type = GL_UNSIGNED_BYTE;
+  int Channels = 4;
+  int BytesPerChannel = 1;
+
+  bool IsInteger() const { return Format == GL_RED_INTEGER; }
+
+  static TextureFormat RGBA8() { return {}; }
+  // Instance ids, 0 is background
+  static TextureFormat R16UI() {
+    return {GL_R16UI, GL_RED_INTEGER, GL_UNSIGNED_SHORT, 1, 2};
+  }
+};
+
+// Block compressed image, Data holds the blocks of mip level 0
+struct CompressedImage {
+  GLenum Format = 0;
+  int Width = 0;
+  int Height = 0;
+  std::vector<unsigned char> Data;
+};
+
+struct DecodedTexture {
+  std::string Path;
+  // TextureManager target height it was decoded for
+  int TargetHeight = 0;
+  PixelBuffer Pixels;
+  CompressedImage Compressed;
+
+  bool IsCompressed() const { return Compressed.Format != 0; }
+  size_t GetSize() const {
+    return IsCompressed() ? Compressed.Data.size() : Pixels.GetSize();
+  }
+};
+
 class Texture {
 public:
   Texture(const std::string &filePath);
+  // Uploads pixels decoded elsewhere, see Decode
+  Texture(const std::string &filePath, const PixelBuffer &pixels);
   Texture(int width, int height, int channels=4);
-  Texture(const std::vector<glm::vec3> &pixelColors);
+  Texture(int width, int height, const TextureFormat &format);
   ~Texture();
 
   void Bind() const;
   void Unbind() const;
 
+  // Decodes an image file without touching GL, safe on worker threads
+  static bool Decode(const std::string &filePath, PixelBuffer &pixels);
+
+  // Respecifies size and contents in place, holders of this texture see the
+  // new image. With an unpack buffer bound data is an offset into it.
+  void SetPixels(int width, int height, int channels, const void *data);
+  void SetCompressedPixels(GLenum format, int width, int height,
+                           GLsizei size, const void *data);
+
   void Save(const std::string &path);
+  static bool Save(const std::string &path, const PixelBuffer &pixels);
+
+  // Pinned textures are never evicted by TextureManager
+  void Pin() { mPins++; }
+  void Unpin() { mPins--; }
+  bool IsPinned() const { return mPins > 0; }
+  // GPU memory of the image including its mip chain
+  size_t GetByteSize() const { return mBytes; }
 
   glm::vec2 GetSize() const { return mSize; }
   const GLuint GetTextureID() const { return mTextureID; }
   const std::string &GetFilePath() const { return mFilePath; }
+  const TextureFormat &GetFormat() const { return mFormat; }
 
 private:
   void initializeCommonMembers(int width, int height, int channels);
@@ -27,6 +87,7 @@ private:
   void setupTextureData(const void *data, GLenum internalFormat, GLenum format,
                         GLenum type);
   void loadTexture(const std::string &filePath);
+  void uploadPixels(const PixelBuffer &pixels);
   void setTextureParameters(GLenum mode);
 
 private:
@@ -34,5 +95,8 @@ private:
   int mWidth, mHeight, mChannels;
   float mAspectRatio;
   glm::vec2 mSize;
+  TextureFormat mFormat;
   std::string mFilePath;
+  int mPins = 0;
+  size_t mBytes = 0;
 };
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Rendering/Textures/BlockCompression.h"
+#include "Rendering/Textures/Texture.h"
+
+#include <cstdint>
+#include <string>
+
+// Binary cache of decoded images per (source path, target height,
+// compression). Entries hold the resized and optionally block compressed
+// pixels and are validated against the source like MeshCache.
+class TextureCache {
+public:
+  TextureCache(const std::string &folder);
+
+  bool Load(const std::string &path, int targetHeight,
+            TextureCompression mode, DecodedTexture &texture) const;
+  bool Save(const std::string &path, int targetHeight,
+            TextureCompression mode, const DecodedTexture &texture) const;
+
+  static constexpr uint32_t Version = 1;
+
+private:
+  std::string cachePath(const std::string &path, int targetHeight,
+                        TextureCompression mode) const;
+
+private:
+  std::string mFolder;
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Rendering/Buffers/PBO.h"
+#include "Rendering/Textures/PixelBuffer.h"
+#include "Rendering/Textures/Texture.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Ring of pixel pack buffers with fences, frame N is read back while frame
+// N+1 renders. Mapped memory is handed to the writer without copying.
+class TextureReadback {
+public:
+  using Writer = std::function<void(const std::string &path, int tag,
+                                    PixelBuffer pixels)>;
+
+  TextureReadback(int numSlots = 3);
+  ~TextureReadback();
+
+  void SetWriter(Writer writer) { mWriter = std::move(writer); }
+
+  // tag is handed back to the writer unchanged. dropAlpha reads RGBA8
+  // textures as RGB, a quarter less to copy and encode when alpha is
+  // constant.
+  void Request(const Texture &texture, const std::string &path, int tag = 0,
+               bool dropAlpha = false);
+  void Poll();
+  void Flush();
+
+  int GetPendingCount() const { return static_cast<int>(mPending); }
+
+private:
+  struct Slot {
+    std::unique_ptr<PBO> Buffer;
+    GLsync Fence = nullptr;
+    std::string Path;
+    int Tag = 0;
+    uint64_t RequestedAt = 0; // Profiler::Now
+    int Width = 0;
+    int Height = 0;
+    int Channels = 0;
+    int BytesPerChannel = 0;
+    std::atomic<bool> InUse{false};
+  };
+
+  bool deliverOldest(GLuint64 timeout);
+  void waitReleased(Slot &slot);
+
+private:
+  std::vector<std::unique_ptr<Slot>> mSlots;
+  size_t mNext = 0;
+  size_t mOldest = 0;
+  size_t mPending = 0;
+  Writer mWriter;
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Rendering/Buffers/PBO.h"
+#include "Rendering/Textures/PixelBuffer.h"
+#include "Rendering/Textures/Texture.h"
+
+#include <memory>
+#include <vector>
+
+// Ring of persistently mapped pixel unpack buffers. The CPU copies the next
+// image while the GPU still reads the previous ones, fences guard reuse.
+class TextureUpload {
+public:
+  TextureUpload(int numSlots = 3);
+  ~TextureUpload();
+
+  // Replaces the contents of texture, the copy into GL memory is async
+  void Upload(Texture &texture, const PixelBuffer &pixels);
+  void Upload(Texture &texture, const CompressedImage &image);
+
+private:
+  struct Slot {
+    std::unique_ptr<PBO> Buffer;
+    GLsync Fence = nullptr;
+  };
+
+  // Copies into the next free slot and leaves its buffer bound
+  Slot &stage(const void *data, size_t size);
+  void waitFence(Slot &slot);
+
+private:
+  std::vector<Slot> mSlots;
+  size_t mNext = 0;
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Helpers shared by the on-disk caches
+namespace CacheFile {
+
+// FNV-1a
+uint64_t HashBytes(const unsigned char *data, size_t size,
+                   uint64_t hash = 14695981039346656037ull);
+
+// Size and modification time of the file an entry was built from
+bool GetSourceInfo(const std::string &path, uint64_t &size, int64_t &time);
+bool HashSource(const std::string &path, uint64_t &hash);
+// Touched but unchanged sources fall back to the content hash. When the hash
+// confirms a source with a new modification time, time is set to it and
+// touched to true so the caller can store it and skip the hash next time.
+bool IsSourceUnchanged(const std::string &path, uint64_t size, int64_t &time,
+                       uint64_t hash, bool &touched);
+
+// <folder>/<hash of key as 16 hex digits><extension>
+std::string GetPath(const std::string &folder, const std::string &key,
+                    const std::string &extension);
+// Overwrites size bytes at offset of an existing file in place, for header
+// fields where a reader seeing the old value is harmless
+bool WriteAt(const std::string &path, size_t offset, const void *data,
+             size_t size);
+// Writes next to the target and renames, readers never see a partial file
+bool WriteAtomic(const std::string &path,
+                 const std::vector<unsigned char> &buffer);
+
+} // namespace CacheFile
@@ -2,7 +2,6 @@
 
 #include "imgui.h"
 #include <glm/glm.hpp>
-#include <glm/gtx/color_space.hpp>
 #include <vector>
 
 namespace Colors {
@@ -53,23 +52,6 @@ inline ImVec4 ImU32ToImVec4(ImU32 col32) {
   );
 }
 
-inline std::vector<glm::vec3> GenerateSegmentedColors(int numMeshes) {
-  float s = 1.0f;
-  float v = 1.0f;
-  std::vector<glm::vec3> colors;
-  colors.resize(numMeshes);
-  for (size_t i = 0; i < numMeshes; i++) {
-    float h = (float(i) / numMeshes) * 360.0f;
-    glm::vec3 hsv = glm::vec3(h, s, v);
-    glm::vec3 color = glm::rgbColor(hsv);
-    color.r = round(color.r * 255.0f) / 255.0f;
-    color.g = round(color.g * 255.0f) / 255.0f;
-    color.b = round(color.b * 255.0f) / 255.0f;
-    colors[i] = color;
-  }
-  return colors;
-}
-
 inline ImVec4 GrayAlphaToImVec4(const float &rgb, const float &alpha) {
   return ImVec4(rgb, rgb, rgb, alpha);
 }
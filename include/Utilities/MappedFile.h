@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Read only memory mapping of a whole file
+class MappedFile {
+public:
+  MappedFile(const std::string &path);
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  // Unmaps early, the data pointer is invalid afterwards
+  void Close();
+
+  bool IsOpen() const { return mData != nullptr; }
+  const unsigned char *GetData() const { return mData; }
+  size_t GetSize() const { return mSize; }
+
+private:
+  const unsigned char *mData = nullptr;
+  size_t mSize = 0;
+#ifdef _WIN32
+  void *mFile = nullptr;
+  void *mMapping = nullptr;
+#else
+  int mFile = -1;
+#endif
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Scoped timers for the hot paths. They are compiled in with OMVEX_PROFILING
+// (CMake option, off by default) and expand to nothing without it.
+//   OMVEX_PROFILE_SCOPE("Name")  CPU time of the enclosing scope
+//   OMVEX_PROFILE_GPU("Name")    CPU time plus a GPU timestamp pair around
+//                                the GL commands of the scope, GL thread only
+// Names must be string literals, only the pointer is stored.
+#ifdef OMVEX_PROFILING
+#define OMVEX_PROFILE_CONCAT_(a, b) a##b
+#define OMVEX_PROFILE_CONCAT(a, b) OMVEX_PROFILE_CONCAT_(a, b)
+#define OMVEX_PROFILE_SCOPE(name)                                              \
+  Profiler::Scope OMVEX_PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define OMVEX_PROFILE_GPU(name)                                                \
+  Profiler::GpuScope OMVEX_PROFILE_CONCAT(profileScope, __LINE__)(name)
+#else
+#define OMVEX_PROFILE_SCOPE(name) ((void)0)
+#define OMVEX_PROFILE_GPU(name) ((void)0)
+#endif
+
+struct ProfileEvent {
+  const char *Name = nullptr;
+  uint64_t StartNs = 0;
+  uint64_t DurationNs = 0;
+};
+
+// Rolling timings of one scope, GPU scopes are listed separately
+struct ProfileStat {
+  std::string Name;
+  bool Gpu = false;
+  int Count = 0;
+  double LastMs = 0.0;
+  double AverageMs = 0.0; // Exponential moving average
+  double MaxMs = 0.0;     // Over the last second
+};
+
+// Every thread records into its own ring of the last events, written without
+// locks or allocation. Readers copy the rings and drop what was overwritten
+// while copying. GPU events are resolved on the GL thread into a ring of
+// their own.
+class Profiler {
+public:
+  static uint64_t Now();
+
+  static void Record(const char *name, uint64_t startNs, uint64_t endNs);
+  // Shown as the thread name in traces, a string literal
+  static void SetThreadName(const char *name);
+
+  // Timestamp queries, returns the query pair for EndGpu
+  static int BeginGpu(const char *name);
+  static void EndGpu(int query);
+  // Reads finished queries, wait blocks until all of them are done
+  static void PollGpu(bool wait = false);
+
+  // Folds new events into the rolling stats, called once per UI frame
+  static void Collect();
+  static std::vector<ProfileStat> GetStats();
+
+  // Chrome trace json of the events recorded since sinceNs, open in
+  // chrome://tracing or ui.perfetto.dev
+  static bool WriteTrace(const std::string &path, uint64_t sinceNs = 0);
+
+  class Scope {
+  public:
+    Scope(const char *name) : mName(name), mStart(Now()) {}
+    ~Scope() { Record(mName, mStart, Now()); }
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+  private:
+    const char *mName;
+    uint64_t mStart;
+  };
+
+  class GpuScope {
+  public:
+    GpuScope(const char *name) : mCpu(name), mQuery(BeginGpu(name)) {}
+    ~GpuScope() { EndGpu(mQuery); }
+
+    GpuScope(const GpuScope &) = delete;
+    GpuScope &operator=(const GpuScope &) = delete;
+
+  private:
+    Scope mCpu;
+    int mQuery;
+  };
+};
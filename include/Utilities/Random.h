@@ -1,44 +1,97 @@
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <glm/glm.hpp>
 #include <glm/gtc/constants.hpp>
-#include <glm/gtc/random.hpp>
 #include <random>
 #include <reactphysics3d/reactphysics3d.h>
 
 namespace Random {
-static std::random_device rd;
-static std::mt19937 gen(rd());
+// What a stream is used for, two purposes of the same sample never share
+// values
+enum class Purpose : uint64_t { Pose = 1, Randomization = 2 };
+
+// SplitMix64 finalizer
+inline uint64_t Mix(uint64_t z) {
+  z += 0x9E3779B97F4A7C15ull;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+// Counter based generator, the n-th value is a pure function of
+// (seed, index, purpose, sub, n). Sample i of a run can be drawn on any
+// thread or machine. The integer stream is portable, values converted to
+// floats through std::sqrt, std::sin or std::cos (UnitVec3,
+// RandomQuaternion) may differ in the last bits between libm versions.
+class Stream {
+public:
+  Stream(uint64_t seed, uint64_t index, Purpose purpose, uint64_t sub = 0)
+      : mKey(Mix(Mix(Mix(seed) ^ index) ^
+                 Mix(static_cast<uint64_t>(purpose) << 32 ^ sub))) {}
+  explicit Stream(uint64_t key) : mKey(key) {}
+
+  uint64_t Next() { return Mix(mKey + 0x9E3779B97F4A7C15ull * mCounter++); }
+  // Uniform in [0, 1)
+  float Unit() { return static_cast<float>(Next() >> 40) * 0x1.0p-24f; }
+
+private:
+  uint64_t mKey;
+  uint64_t mCounter = 0;
+};
+
+// Unseeded per thread stream for interactive use where reproducibility does
+// not matter
+inline Stream &ThreadStream() {
+  static thread_local Stream stream(std::random_device{}() |
+                                    uint64_t(std::random_device{}()) << 32);
+  return stream;
+}
 
 // Generate a random integer between min and max (inclusive)
-inline int Int(int min, int max) {
-  std::uniform_int_distribution<int> dist(min, max);
-  return dist(gen);
+inline int Int(int min, int max, Stream &rng = ThreadStream()) {
+  if (max <= min) return min;
+  uint64_t range = static_cast<uint64_t>(int64_t(max) - min) + 1;
+  return static_cast<int>(min + static_cast<int64_t>(
+                                    ((rng.Next() >> 32) * range) >> 32));
 }
 
 // Generate a random float between min and max
-inline float Float(float min, float max) {
-  std::uniform_real_distribution<float> dist(min, max);
-  return dist(gen);
+inline float Float(float min, float max, Stream &rng = ThreadStream()) {
+  return min + (max - min) * rng.Unit();
 }
 
 // Generate a random glm::vec2 with each component between min and max
-inline glm::vec2 Vec2(float min, float max) {
-  return glm::vec2(Float(min, max), Float(min, max));
+inline glm::vec2 Vec2(float min, float max, Stream &rng = ThreadStream()) {
+  float x = Float(min, max, rng);
+  return glm::vec2(x, Float(min, max, rng));
 }
 
 // Generate a random glm::vec3 with each component between min and max
-inline glm::vec3 Vec3(float min, float max) {
-  return glm::vec3(Float(min, max), Float(min, max), Float(min, max));
+inline glm::vec3 Vec3(float min, float max, Stream &rng = ThreadStream()) {
+  float x = Float(min, max, rng);
+  float y = Float(min, max, rng);
+  return glm::vec3(x, y, Float(min, max, rng));
+}
+
+// Generate a random unit vector
+inline glm::vec3 UnitVec3(Stream &rng = ThreadStream()) {
+  float z = Float(-1.0f, 1.0f, rng);
+  float phi = Float(0.0f, glm::two_pi<float>(), rng);
+  float r = std::sqrt(std::max(0.0f, 1.0f - z * z));
+  return glm::vec3(r * std::cos(phi), r * std::sin(phi), z);
 }
 
 // Function to generate a random quaternion
-inline reactphysics3d::Quaternion RandomQuaternion() {
+inline reactphysics3d::Quaternion
+RandomQuaternion(Stream &rng = ThreadStream()) {
   // Generate a random unit axis
-  glm::vec3 randomAxis = glm::sphericalRand(1.0f); // Random unit vector
+  glm::vec3 randomAxis = UnitVec3(rng);
 
   // Generate a random rotation angle (0 to 2π radians)
-  float randomAngle = glm::linearRand(0.0f, glm::two_pi<float>());
+  float randomAngle = Float(0.0f, glm::two_pi<float>(), rng);
 
   // Convert axis-angle to quaternion using the quaternion formula
   float halfAngle = randomAngle * 0.5f;
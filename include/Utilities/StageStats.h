@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Utilities/Profiler.h"
+
+// Pipeline stages of one render, timed for benchmarks
+enum class Stage { Settle, Render, Readback, Encode, Write, Count };
+
+struct StageSummary {
+  int Count = 0;
+  double P50Ms = 0.0;
+  double P99Ms = 0.0;
+  double MeanMs = 0.0;
+  double MaxMs = 0.0;
+};
+
+// Collects every stage duration of a run while enabled, off by default so
+// the normal generator keeps no samples. Record is thread safe. Timestamps
+// come from Profiler::Now, with OMVEX_PROFILING the same interval is also
+// recorded as a trace event under traceName, so a stage is timed only once.
+class StageStats {
+public:
+  static void SetEnabled(bool enabled);
+  static bool IsEnabled();
+  // traceName may be null for intervals that do not nest on one thread
+  static void Record(Stage stage, uint64_t startNs, uint64_t endNs,
+                     const char *traceName = nullptr);
+  static void Reset();
+
+  static StageSummary GetSummary(Stage stage);
+  // Lower case, "settle", "render", ...
+  static const char *GetName(Stage stage);
+
+  // Records the lifetime of the scope into stage
+  class Scope {
+  public:
+    Scope(Stage stage, const char *traceName)
+        : mStage(stage), mTraceName(traceName), mStart(Profiler::Now()) {}
+    ~Scope() { Record(mStage, mStart, Profiler::Now(), mTraceName); }
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+  private:
+    Stage mStage;
+    const char *mTraceName;
+    uint64_t mStart;
+  };
+};
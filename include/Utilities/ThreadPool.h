@@ -0,0 +1,101 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Fixed size worker pool. Submit blocks while maxQueued tasks are waiting
+// (0 means unbounded), which gives producers back-pressure.
+class ThreadPool {
+public:
+  ThreadPool(int numThreads, size_t maxQueued = 0) : mMaxQueued(maxQueued) {
+    numThreads = std::max(1, numThreads);
+    for (int i = 0; i < numThreads; i++) {
+      mWorkers.emplace_back([this]() { workerLoop(); });
+    }
+  }
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mStopping = true;
+    }
+    mTaskAvailable.notify_all();
+    mSpaceAvailable.notify_all();
+    for (std::thread &worker : mWorkers) {
+      worker.join();
+    }
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  void Submit(std::function<void()> task) {
+    std::unique_lock<std::mutex> lock(mMutex);
+    mSpaceAvailable.wait(lock, [this]() {
+      return mMaxQueued == 0 || mTasks.size() < mMaxQueued || mStopping;
+    });
+    mTasks.push(std::move(task));
+    lock.unlock();
+    mTaskAvailable.notify_one();
+  }
+
+  // Blocks until every submitted task has finished
+  void Wait() {
+    std::unique_lock<std::mutex> lock(mMutex);
+    mIdle.wait(lock, [this]() { return mTasks.empty() && mActive == 0; });
+  }
+
+  size_t GetQueued() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mTasks.size();
+  }
+  size_t GetActive() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mActive;
+  }
+  int GetThreadCount() const { return static_cast<int>(mWorkers.size()); }
+
+  static int DefaultThreadCount() {
+    int hardware = static_cast<int>(std::thread::hardware_concurrency());
+    return std::max(1, hardware - 1);
+  }
+
+private:
+  void workerLoop() {
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mTaskAvailable.wait(lock,
+                            [this]() { return mStopping || !mTasks.empty(); });
+        if (mTasks.empty()) return;
+        task = std::move(mTasks.front());
+        mTasks.pop();
+        mActive++;
+      }
+      mSpaceAvailable.notify_one();
+      task();
+      {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mActive--;
+        if (mTasks.empty() && mActive == 0) mIdle.notify_all();
+      }
+    }
+  }
+
+private:
+  std::vector<std::thread> mWorkers;
+  std::queue<std::function<void()>> mTasks;
+  size_t mMaxQueued = 0;
+  size_t mActive = 0;
+  bool mStopping = false;
+
+  mutable std::mutex mMutex;
+  std::condition_variable mTaskAvailable;
+  std::condition_variable mSpaceAvailable;
+  std::condition_variable mIdle;
+};
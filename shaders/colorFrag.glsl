@@ -1,30 +1,43 @@
 #version 460 core
 
-out vec4 FragColor;
+layout (location = 0) out vec4 FragColor;
+layout (location = 1) out uint InstanceId;
 
 in vec3 fragColor;
 in vec3 fragNormal;
 in vec3 fragPos;
 
 in vec2 texCoords;
+flat in uint instanceId;
+flat in uint hasTexture;
 
-uniform bool uHasTexture;
 uniform sampler2D uTex1;
 
-vec3 lightPos = vec3(100,100,100);
-vec3 lightColor = vec3(1,1,1);
+layout (std140, binding = 1) uniform RandomizationBlock
+{
+    vec4 uLightDirs[4];
+    vec4 uLightColors[4];
+    vec4 uAmbient;
+    vec4 uTint;
+    int uLightCount;
+    float uNoise;
+    float uBlur;
+    float uExposure;
+    float uDim;
+    uint uNoiseSeed;
+};
 
 void main()
 {
   vec3 norm = normalize(fragNormal);
-  vec3 lightDir = normalize(lightPos - fragPos);
-  float diff = max(dot(norm, lightDir), 0.0);
-  vec3 diffuse = diff * lightColor;
-  vec3 ambient = 0.4 * lightColor;
-  vec3 result = (ambient + diffuse);
+  vec3 result = uAmbient.rgb;
+  for (int i = 0; i < uLightCount; i++) {
+    result += max(dot(norm, uLightDirs[i].xyz), 0.0) * uLightColors[i].rgb;
+  }
+  result *= uTint.rgb;
 
   vec4 texColor = texture(uTex1, texCoords);
-  if(uHasTexture){
+  if(hasTexture != 0u){
     result *= texColor.rgb;
   }
   else{
@@ -32,4 +45,5 @@ void main()
   }
 
   FragColor = vec4(result, 1.0f);
+  InstanceId = instanceId;
 }
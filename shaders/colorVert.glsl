@@ -5,20 +5,48 @@ layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec3 aColor;
 layout (location = 3) in vec2 aTex;
 
-uniform mat4 uCamMatrix;
-uniform mat4 uModel;
+layout (std140, binding = 0) uniform CameraBlock
+{
+    mat4 uCamMatrix;
+    vec4 uCamPos;
+};
+
+struct DrawData
+{
+    uint ModelIndex;
+    uint InstanceId;
+    uint HasTexture;
+    uint Padding;
+};
+
+layout (std430, binding = 1) readonly buffer ModelMatrices
+{
+    mat4 uModels[];
+};
+layout (std430, binding = 2) readonly buffer Draws
+{
+    DrawData uDraws[];
+};
+
 uniform mat4 uMatrix;
 
 out vec3 fragColor;
 out vec3 fragNormal;
 out vec3 fragPos;
 out vec2 texCoords;
+flat out uint instanceId;
+flat out uint hasTexture;
 
 void main()
 {
-    fragNormal = mat3(transpose(inverse(uModel))) * aNormal;
-    fragPos = vec3(uModel * vec4(aPos, 1.0));
+    DrawData draw = uDraws[gl_BaseInstance];
+    mat4 model = uModels[draw.ModelIndex];
+    instanceId = draw.InstanceId;
+    hasTexture = draw.HasTexture;
+
+    fragNormal = mat3(transpose(inverse(model))) * aNormal;
+    fragPos = vec3(model * vec4(aPos, 1.0));
     texCoords = aTex;
 
-    gl_Position = uCamMatrix * uMatrix * uModel * vec4(aPos, 1.0f);
+    gl_Position = uCamMatrix * uMatrix * model * vec4(aPos, 1.0f);
 }
@@ -0,0 +1,62 @@
+#version 460 core
+
+in vec2 vTexCoord;
+out vec4 FragColor;
+
+uniform sampler2D uColor;
+
+layout (std140, binding = 1) uniform RandomizationBlock
+{
+    vec4 uLightDirs[4];
+    vec4 uLightColors[4];
+    vec4 uAmbient;
+    vec4 uTint;
+    int uLightCount;
+    float uNoise;
+    float uBlur;
+    float uExposure;
+    float uDim;
+    uint uNoiseSeed;
+};
+
+// PCG hash, one uniform number in [0, 1) per pixel and seed
+float random(uvec2 pixel, uint seed)
+{
+  uint state = pixel.x * 747796405u + pixel.y * 2891336453u + seed;
+  state = state * 747796405u + 2891336453u;
+  uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+  word = (word >> 22u) ^ word;
+  return float(word) / 4294967296.0;
+}
+
+vec3 blurred()
+{
+  if (uBlur <= 0.0) return texture(uColor, vTexCoord).rgb;
+  // 3x3 tent filter with taps spread over the blur radius
+  vec2 step = uBlur / vec2(textureSize(uColor, 0));
+  vec3 sum = vec3(0.0);
+  float total = 0.0;
+  for (int y = -1; y <= 1; y++) {
+    for (int x = -1; x <= 1; x++) {
+      float weight = (2.0 - abs(float(x))) * (2.0 - abs(float(y)));
+      sum += weight * texture(uColor, vTexCoord + vec2(x, y) * step).rgb;
+      total += weight;
+    }
+  }
+  return sum / total;
+}
+
+void main()
+{
+  vec3 color = blurred();
+  color *= exp2(uExposure);
+  color *= (1.0 - uDim);
+  if (uNoise > 0.0) {
+    // Sum of uniforms approximates gaussian sensor noise
+    uvec2 pixel = uvec2(gl_FragCoord.xy);
+    float n = random(pixel, uNoiseSeed) + random(pixel, uNoiseSeed + 1u) +
+              random(pixel, uNoiseSeed + 2u) - 1.5;
+    color += vec3(n * 2.0 * uNoise);
+  }
+  FragColor = vec4(clamp(color, 0.0, 1.0), 1.0);
+}
@@ -0,0 +1,25 @@
+#version 460 core
+
+in vec2 vTexCoord;
+out vec4 FragColor;
+
+uniform usampler2D uInstanceIds;
+uniform uint uInstanceCount;
+
+vec3 hsv2rgb(vec3 c)
+{
+  vec3 p = abs(fract(c.xxx + vec3(1.0, 2.0 / 3.0, 1.0 / 3.0)) * 6.0 - 3.0);
+  return c.z * mix(vec3(1.0), clamp(p - 1.0, 0.0, 1.0), c.y);
+}
+
+void main()
+{
+  ivec2 texel = ivec2(vTexCoord * vec2(textureSize(uInstanceIds, 0)));
+  uint id = texelFetch(uInstanceIds, texel, 0).r;
+  if(id == 0u){
+    FragColor = vec4(0.0, 0.0, 0.0, 1.0);
+    return;
+  }
+  float hue = float(id - 1u) / float(max(uInstanceCount, 1u));
+  FragColor = vec4(hsv2rgb(vec3(hue, 1.0, 1.0)), 1.0);
+}
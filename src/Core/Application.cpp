@@ -9,10 +9,11 @@
 #include <memory>
 
 Application::Application() {
-  findBaseFolders();
+  mBaseFolders = FindBaseFolders();
   mContext = std::make_unique<Context>(mBaseFolders->Config);
 
   mTextureManager = std::make_unique<TextureManager>();
+  mTextureManager->SetCache(mBaseFolders->Cache + "textures");
   mExampleLoader = std::make_unique<ExampleLoader>(mBaseFolders->Example);
   mTutorialLoader = std::make_unique<TutorialLoader>(mBaseFolders->Resources,
                                                      mTextureManager.get());
@@ -148,7 +149,7 @@ void Application::handleModeSelection() {
   }
 }
 
-void Application::findBaseFolders() {
+std::unique_ptr<BaseFolders> Application::FindBaseFolders() {
   std::vector<std::string> possibleConfigsPaths = {"../configs/",
                                                    "../../configs/"};
   std::string configsFolder =
@@ -158,13 +159,13 @@ void Application::findBaseFolders() {
   }
   std::string rootFolder = FileSystem::GetDirectoryFromPath(
       FileSystem::GetDirectoryFromPath(configsFolder));
-  std::string activeFolder = rootFolder;
-  mBaseFolders = std::make_unique<BaseFolders>();
-  mBaseFolders->Root = FileSystem::GetDirectoryFromPath(
-      FileSystem::GetDirectoryFromPath(configsFolder));
-  mBaseFolders->Config = configsFolder;
-  mBaseFolders->Active = "";
-  mBaseFolders->Example = rootFolder + "/example/";
-  mBaseFolders->Shaders = rootFolder + "/shaders/";
-  mBaseFolders->Resources = rootFolder + "/resources/";
+  auto baseFolders = std::make_unique<BaseFolders>();
+  baseFolders->Root = rootFolder;
+  baseFolders->Config = configsFolder;
+  baseFolders->Active = "";
+  baseFolders->Example = rootFolder + "/example/";
+  baseFolders->Shaders = rootFolder + "/shaders/";
+  baseFolders->Resources = rootFolder + "/resources/";
+  baseFolders->Cache = rootFolder + "/cache/";
+  return baseFolders;
 }
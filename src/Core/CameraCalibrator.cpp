@@ -347,6 +347,7 @@ void CameraCalibrator::handleLoad() {
 
 void CameraCalibrator::onParamChange() {
   mCameraParameters = mCameraParametersManager.GetCameraParameter();
+  if (mTexture) mTexture->Unpin();
   if (!mCameraParameters) {
     mTexture = nullptr;
     mImageSize = glm::vec2(0.0f);
@@ -357,6 +358,7 @@ void CameraCalibrator::onParamChange() {
       mCameraParameters->RefImageFileName;
 
   mTexture = mTextureManager->GetTexture(refImageFilePath);
+  mTexture->Pin();
   mChanged = true;
   Logger::Debug("Camera parameters changed: " + mCameraParameters->Path +
                 " | Texture: " + refImageFilePath);
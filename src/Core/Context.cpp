@@ -16,9 +16,15 @@ static void framebuffer_size_callback(GLFWwindow *window, int width,
   Logger::Info(info);
 }
 
-Context::Context(std::string &configsFolder) : mConfigsFolder(configsFolder) {
+Context::Context(std::string &configsFolder, bool headless)
+    : mConfigsFolder(configsFolder), mHeadless(headless) {
+#if defined(GLFW_PLATFORM_NULL) && !defined(_WIN32)
+  // Null platform needs no display server, context comes from EGL or OSMesa
+  if (mHeadless) glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#endif
   if (!glfwInit()) {
     Logger::Error("Failed to initialize glfw");
+    return;
   }
   Logger::Success("Initialized glfw");
 
@@ -26,22 +32,35 @@ Context::Context(std::string &configsFolder) : mConfigsFolder(configsFolder) {
   glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
   glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
-  mWindow = glfwCreateWindow(1000, 1000, "Omvex", nullptr, nullptr);
+  if (mHeadless) {
+    mWindow = createHeadlessWindow();
+  } else {
+    mWindow = glfwCreateWindow(1000, 1000, "Omvex", nullptr, nullptr);
+  }
 
+  // Without a window or GL functions nothing below can run, callers check
+  // IsValid
   if (!mWindow) {
     Logger::Error("Failed to initialize window");
-  } else {
-    Logger::Success("Initialized window");
+    return;
   }
+  Logger::Success("Initialized window");
 
   glfwMakeContextCurrent(mWindow);
-  glfwSetFramebufferSizeCallback(mWindow, framebuffer_size_callback);
   if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
     Logger::Error("Failed to initialize glad");
-  } else {
-    Logger::Success("Initialized glad");
+    return;
+  }
+  Logger::Success("Initialized glad");
+  mValid = true;
+
+  if (mHeadless) {
+    Logger::Info("Headless context initialized: " +
+                 std::string((const char *)glGetString(GL_RENDERER)));
+    return;
   }
 
+  glfwSetFramebufferSizeCallback(mWindow, framebuffer_size_callback);
   glfwMaximizeWindow(mWindow);
   glfwSwapInterval(0); // 0 means uncapped, 1 would enable V-Sync
 
@@ -50,6 +69,22 @@ Context::Context(std::string &configsFolder) : mConfigsFolder(configsFolder) {
   Logger::Info("Context initialized");
 }
 
+// Offscreen window that only carries the GL context, rendering goes to FBOs
+GLFWwindow *Context::createHeadlessWindow() {
+  glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+#ifndef _WIN32
+  for (int api : {GLFW_EGL_CONTEXT_API, GLFW_OSMESA_CONTEXT_API}) {
+    glfwWindowHint(GLFW_CONTEXT_CREATION_API, api);
+    GLFWwindow *window = glfwCreateWindow(1, 1, "Omvex", nullptr, nullptr);
+    if (window) return window;
+    Logger::Warn("Headless context creation failed, trying next API");
+  }
+  return nullptr;
+#else
+  return glfwCreateWindow(1, 1, "Omvex", nullptr, nullptr);
+#endif
+}
+
 void Context::setupImGui() {
   IMGUI_CHECKVERSION();
   ImGui::CreateContext();
@@ -209,9 +244,11 @@ void Context::EndFrame() {
 }
 
 Context::~Context() {
-  ImGui_ImplOpenGL3_Shutdown();
-  ImGui_ImplGlfw_Shutdown();
-  ImGui::DestroyContext();
+  if (mValid && !mHeadless) {
+    ImGui_ImplOpenGL3_Shutdown();
+    ImGui_ImplGlfw_Shutdown();
+    ImGui::DestroyContext();
+  }
 
   glfwDestroyWindow(mWindow);
   glfwTerminate();
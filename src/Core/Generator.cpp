@@ -1,33 +1,91 @@
 #include "Core/Generator.h"
 
+#include "Rendering/Shaders/Renderer.h"
 #include "Utilities/FileSystem.h"
+#include "Utilities/Profiler.h"
 
-#define SUBFOLDER_COLOR "color/"
-#define SUBFOLDER_SEGMENTATION "segmentation/"
-#define SUBFOLDER_POSE_DATA "poses/"
+#include <algorithm>
+#include <random>
+
+// Subfolder of the loose files, part name of the tar members
+#define IMAGE_COLOR "color"
+#define IMAGE_SEGMENTATION "segmentation"
 
 Generator::Generator(CameraManager *camMng, ModelManager *modelMng,
-                     PhysicsManager *phyMng, ViewMode *viewMode)
-    : mCameraManager(camMng), mModelManager(modelMng), mPhysicsManager(phyMng),
-      mViewMode(viewMode) {}
+                     PhysicsManager *phyMng)
+    : mCameraManager(camMng), mModelManager(modelMng), mPhysicsManager(phyMng) {
+  // Fresh seed per session unless set, it is logged on start to reproduce
+  std::random_device device;
+  mSeed = uint64_t(device()) << 32 | device();
+  mImageWriter = std::make_unique<ImageWriter>();
+  // Each in-flight encode holds a readback slot, leave room for the renderer
+  mReadback = std::make_unique<TextureReadback>(
+      mImageWriter->GetThreadCount() + 2);
+  mReadback->SetWriter(
+      [this](const std::string &path, int target, PixelBuffer pixels) {
+        mImageWriter->Write(path, std::move(pixels),
+                            target == TargetSegmentation
+                                ? mSegmentationEncoder
+                                : mColorEncoder);
+      });
+}
 
-void Generator::Start(const std::string &outputFolder) {
-  if (outputFolder.empty()) return;
+bool Generator::Start(const std::string &outputFolder) {
+  if (outputFolder.empty()) return false;
 
   mStartTime = std::chrono::high_resolution_clock::now();
+  mTraceStart = Profiler::Now();
+  Profiler::SetThreadName("Main");
   mOutputFolder = outputFolder + "/";
 
-  mRenderId = 0;
-  mRenderSubId = 0;
+  if (mTarShardMB > 0) {
+    // Color, segmentation and pose of a render form one sample
+    mTarWriter = std::make_unique<TarWriter>(
+        mOutputFolder, size_t(mTarShardMB) << 20, 3);
+    mImageWriter->SetSink(
+        [this](const std::string &name, std::vector<unsigned char> data) {
+          addTarMember(name, std::move(data));
+        });
+  } else {
+    FileSystem::CreateDir(mOutputFolder + IMAGE_COLOR);
+    FileSystem::CreateDir(mOutputFolder + IMAGE_SEGMENTATION);
+    mPoseWriter = std::make_unique<PoseWriter>(mPoseFormat);
+    if (!mPoseWriter->Open(mOutputFolder, mPhysicsManager->GetBodyCount())) {
+      // Renders without their poses are useless, do not start at all
+      Logger::Error("Generator: Failed to open the pose output in " +
+                    mOutputFolder);
+      mPoseWriter.reset();
+      return false;
+    }
+    mImageWriter->SetSink(nullptr);
+  }
+
+  // Scene i renders images [i * cameras, (i + 1) * cameras)
+  int cameras = std::max(1, mCameraManager->GetCount());
+  if (mFirstRender % cameras != 0) {
+    Logger::Warn("Generator: First render " + std::to_string(mFirstRender) +
+                 " is not a multiple of the camera count");
+  }
+  int64_t firstScene = mFirstRender / cameras;
+  mRenderId = static_cast<int>(firstScene) * cameras;
+  // Color is read as RGB, segmentation holds exact 16 bit labels
+  mColorEncoder = createEncoder(mColorFormat, 3, 1, false);
+  mSegmentationEncoder = createEncoder(mSegmentationFormat, 1, 2, true);
+  mSceneIndex = firstScene - 1;
   mRunning = true;
+  mSceneApplied = false;
+  mStepsToRest.clear();
+  mStopReasons.assign(3, 0);
+  mImageWriter->ResetStats();
 
-  FileSystem::CreateDir(mOutputFolder + SUBFOLDER_COLOR);
-  FileSystem::CreateDir(mOutputFolder + SUBFOLDER_SEGMENTATION);
-  FileSystem::CreateDir(mOutputFolder + SUBFOLDER_POSE_DATA);
+  if (mPhysicsManager->GetBodyCount() > 0) {
+    mPhysicsBatch = std::make_unique<PhysicsBatch>(mPhysicsWorlds, mSeed);
+    mPhysicsBatch->SetBodies(mModelManager->GetModels(),
+                             mPhysicsManager->GetSpawningSpace());
+    mPhysicsBatch->Start(firstScene);
+  }
 
-  std::vector<glm::vec3> colors = mModelManager->GetSegmentedColors();
-  Texture uniqueColorsTexture = Texture(colors);
-  uniqueColorsTexture.Save(mOutputFolder + "unique_colors.png");
+  saveLabels();
 
   std::ofstream file(mOutputFolder + "model_names.txt");
   if (file.is_open()) {
@@ -38,14 +96,22 @@ void Generator::Start(const std::string &outputFolder) {
   } else {
     Logger::Error("Failed to open modle names file");
   }
-  Logger::Info("Generator started");
+  Logger::Info("Generator started, seed " + std::to_string(mSeed));
+  return true;
 }
 
 void Generator::Stop() {
+  mPhysicsBatch.reset();
+  mReadback->Flush();
+  mImageWriter->Drain();
+  mPoseWriter.reset();
+  mTarWriter.reset();
+#ifdef OMVEX_PROFILING
+  Profiler::PollGpu(true);
+  Profiler::WriteTrace(mOutputFolder + "trace.json", mTraceStart);
+#endif
   Logger::Info("Generator stopped");
   mRunning = false;
-  mRenderId = 0;
-  mRenderSubId = 0;
   auto endTime = std::chrono::high_resolution_clock::now();
   auto duration = endTime - mStartTime;
   auto totalSeconds =
@@ -61,76 +127,152 @@ void Generator::Stop() {
        << seconds;
 
   Logger::Success("Completed in: " + time.str());
+
+  ImageWriterStats stats = mImageWriter->GetStats();
+  std::ostringstream writer;
+  writer << "Images written: " << stats.Written << ", avg latency "
+         << std::fixed << std::setprecision(1) << stats.AverageLatencyMs
+         << " ms, max latency " << stats.MaxLatencyMs
+         << " ms, max queue depth " << stats.MaxQueueDepth;
+  Logger::Info(writer.str());
+  logSimulationStats();
 }
 
 void Generator::Update() {
-  if (!mRunning || !mCameraManager || !mViewMode) return;
-
-  saveImage();
-
-  int numViewModes = static_cast<int>(ViewMode::Count);
-  mRenderSubId++;
-  if (mRenderSubId == numViewModes) {
-    saveTransforms();
-    mRenderId++;
-    mCameraManager->SwitchNext();
-    mRenderSubId = 0;
-  }
+  if (!mRunning || !mCameraManager) return;
+  OMVEX_PROFILE_SCOPE("Generator::Update");
 
-  int viewModeInt = static_cast<int>(*mViewMode);
-  viewModeInt++;
-  viewModeInt %= numViewModes;
-  *mViewMode = static_cast<ViewMode>(viewModeInt);
-
-  if (mRenderId >= mNumRenders) {
-    Stop();
-    return;
+  // The scene applied on the previous update has since been rendered by
+  // every camera, save all views before moving on to the next one
+  if (mSceneApplied) {
+    saveViews();
+    if (mRenderId >= mNumRenders) {
+      Stop();
+      return;
+    }
   }
+  mSceneApplied = applyNextScene();
 }
 
-std::string Generator::getFileName() const {
+std::string Generator::getFileName(int renderId) const {
   std::ostringstream oss;
-  oss << std::setfill('0') << std::setw(5) << mRenderId;
+  oss << std::setfill('0') << std::setw(5) << renderId;
   return oss.str();
 }
-std::string Generator::getSubfolder() const {
-  switch (mRenderSubId) {
-  case 0: return SUBFOLDER_COLOR;
-  case 1: return SUBFOLDER_SEGMENTATION;
-  case 2: return SUBFOLDER_POSE_DATA;
-  default: return SUBFOLDER_COLOR;
+
+void Generator::saveViews() {
+  OMVEX_PROFILE_SCOPE("Generator::saveViews");
+  std::vector<std::unique_ptr<Camera>> &cameras = mCameraManager->GetCameras();
+  std::vector<std::unique_ptr<FBO>> &fbos = mCameraManager->GetFBOs();
+  int count = std::min(static_cast<int>(cameras.size()),
+                       mNumRenders - mRenderId);
+  for (int i = 0; i < count; i++) {
+    std::string fileName = getFileName(mRenderId + i);
+    // Both targets come from the same geometry pass
+    saveImage(fbos[i].get(), TargetColor, IMAGE_COLOR, fileName);
+    saveImage(fbos[i].get(), TargetSegmentation, IMAGE_SEGMENTATION, fileName);
+    if (mTarWriter) {
+      PoseWriter::FormatLine(mRenderId + i, *cameras[i]->GetParameters(),
+                             mPhysicsManager->GetBodies(), mPoseLine);
+      mTarWriter->Add(fileName, "pose.json",
+                      std::vector<unsigned char>(mPoseLine.begin(),
+                                                 mPoseLine.end()));
+    } else {
+      mPoseWriter->Write(mRenderId + i, fileName,
+                         *cameras[i]->GetParameters(),
+                         mPhysicsManager->GetBodies());
+    }
+  }
+  mReadback->Poll();
+  mRenderId += count;
+  mSceneApplied = false;
+}
+
+bool Generator::applyNextScene() {
+  if (!mPhysicsBatch) {
+    mSceneIndex++;
+    return true;
   }
+
+  // Scenes still settling are picked up on a later frame
+  SettledScene scene;
+  bool popped = mWaitForPhysics ? mPhysicsBatch->Pop(scene)
+                                : mPhysicsBatch->TryPop(scene);
+  if (!popped) return false;
+  mSceneIndex = scene.Index;
+  mStepsToRest.push_back(scene.Result.Steps);
+  mStopReasons[static_cast<int>(scene.Result.Reason)]++;
+  mPhysicsManager->SetTransforms(scene.Result.Transforms,
+                                 mModelManager->GetModels());
+  return true;
 }
 
-void Generator::saveImage() {
-  std::string path = mOutputFolder + getSubfolder() + getFileName() + ".png";
-  FBO *fbo = mCameraManager->GetFBO();
-  if (fbo && fbo->ColorTexture) {
-    fbo->ColorTexture->Save(path);
+void Generator::logSimulationStats() const {
+  if (mStepsToRest.empty()) return;
+
+  Logger::Info("Scenes simulated: " + std::to_string(mStepsToRest.size()) +
+               ", asleep " + std::to_string(mStopReasons[0]) + ", settled " +
+               std::to_string(mStopReasons[1]) + ", hit step cap " +
+               std::to_string(mStopReasons[2]));
+
+  constexpr int bins = 10;
+  int maxSteps = std::max(1, mPhysicsManager->GetMaxSteps());
+  int binWidth = (maxSteps + bins - 1) / bins;
+  std::vector<int> histogram(bins, 0);
+  for (int steps : mStepsToRest) {
+    histogram[std::min(bins - 1, (steps - 1) / binWidth)]++;
   }
-  Logger::Info("Image saved: " + path);
+  std::ostringstream oss;
+  oss << "Steps to rest:";
+  for (int i = 0; i < bins; i++) {
+    if (histogram[i] == 0) continue;
+    oss << " [" << i * binWidth + 1 << "-" << (i + 1) * binWidth
+        << "]: " << histogram[i];
+  }
+  Logger::Info(oss.str());
 }
-void Generator::saveTransforms() {
+
+void Generator::saveImage(FBO *fbo, int target, const std::string &image,
+                          const std::string &fileName) {
+  const ImageEncoder &encoder =
+      target == TargetSegmentation ? *mSegmentationEncoder : *mColorEncoder;
+  // Tar members are named <key>.<image><extension>, see addTarMember
   std::string path =
-      mOutputFolder + SUBFOLDER_POSE_DATA + getFileName() + ".json";
-  std::ofstream outFile(path);
+      mTarWriter ? fileName + "." + image + encoder.GetExtension()
+                 : mOutputFolder + image + "/" + fileName +
+                       encoder.GetExtension();
+  if (fbo && fbo->GetColorTexture(target)) {
+    // Alpha of the color target is always 1
+    mReadback->Request(*fbo->GetColorTexture(target), path, target,
+                       target == TargetColor);
+  }
+}
+std::shared_ptr<const ImageEncoder>
+Generator::createEncoder(const std::string &spec, int channels,
+                         int bytesPerChannel, bool lossless) const {
+  std::shared_ptr<const ImageEncoder> encoder = ImageEncoder::Create(spec);
+  if (!encoder || !encoder->Supports(channels, bytesPerChannel) ||
+      (lossless && !encoder->IsLossless())) {
+    Logger::Warn("Generator: Image format " + spec +
+                 " does not fit this output, using png");
+    encoder = std::make_shared<PngEncoder>();
+  }
+  return encoder;
+}
+void Generator::addTarMember(const std::string &name,
+                             std::vector<unsigned char> data) {
+  size_t dot = name.find('.');
+  mTarWriter->Add(name.substr(0, dot), name.substr(dot + 1), std::move(data));
+}
+void Generator::saveLabels() {
+  // Segmentation pixels hold the model index + 1, 0 is background
   json j;
-  int id = 0;
-  for (const auto &body : mPhysicsManager->GetBodies()) {
-    const auto &transform = body->getTransform();
-    const auto &pos = transform.getPosition();
-    const auto &quat = transform.getOrientation();
-
-    j["bodies"][id]["position"] = {pos.x, pos.y, pos.z};
-    j["bodies"][id]["quaternion"] = {quat.x, quat.y, quat.z, quat.w};
-    id++;
+  j["format"] = "uint16";
+  j["labels"]["0"] = "background";
+  const std::vector<std::string> &names = mModelManager->GetModelNames();
+  for (size_t i = 0; i < names.size(); i++) {
+    j["labels"][std::to_string(i + 1)] = names[i];
   }
-  CameraParameters *params = mCameraManager->GetCamera()->GetParameters();
-  Serialize::ToJson::Vec(j["camera"]["tvec"], params->Tvec);
-  Serialize::ToJson::Vec(j["camera"]["rvec"], params->Rvec);
-  Serialize::ToJson::Mat(j["camera"]["intrinsics"], params->Intrinsic);
-  Serialize::ToJson::Vec(j["camera"]["distortion"], params->Distortion);
-  Serialize::ToJson::Vec(j["camera"]["calibrated_size"],
-                         params->ImageCalibratedSize);
+  std::ofstream outFile(mOutputFolder + "labels.json");
   outFile << j.dump(4);
 }
@@ -0,0 +1,337 @@
+#include "Core/HeadlessApplication.h"
+
+#include "Core/Application.h"
+#include "Core/Logger.h"
+#include "Utilities/FileSystem.h"
+#include "Utilities/Serialize.h"
+#include "Utilities/StageStats.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+HeadlessSettings HeadlessSettings::Parse(int argc, char **argv) {
+  HeadlessSettings settings;
+  settings.Executable = argv[0];
+  settings.Args.assign(argv + 1, argv + argc);
+  std::vector<std::string> *list = nullptr;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--headless") {
+      list = nullptr;
+    } else if (arg == "--output" && hasValue) {
+      settings.OutputFolder = argv[++i];
+    } else if (arg == "--renders" && hasValue) {
+      settings.NumRenders = std::atoi(argv[++i]);
+    } else if (arg == "--physics-worlds" && hasValue) {
+      settings.PhysicsWorlds = std::atoi(argv[++i]);
+    } else if (arg == "--texture-compression" && hasValue) {
+      if (!BlockCompression::Parse(argv[++i], settings.Compression)) {
+        Logger::Warn("Headless: Unknown texture compression " +
+                     std::string(argv[i]));
+      }
+    } else if (arg == "--pose-format" && hasValue) {
+      if (!PoseWriter::Parse(argv[++i], settings.Poses)) {
+        Logger::Warn("Headless: Unknown pose format " + std::string(argv[i]));
+      }
+    } else if (arg == "--color-format" && hasValue) {
+      settings.ColorFormat = argv[++i];
+    } else if (arg == "--segmentation-format" && hasValue) {
+      settings.SegmentationFormat = argv[++i];
+    } else if (arg == "--tar-shard" && hasValue) {
+      settings.TarShardMB = std::atoi(argv[++i]);
+    } else if (arg == "--texture-budget" && hasValue) {
+      settings.TextureBudgetMB = std::atoi(argv[++i]);
+    } else if (arg == "--seed" && hasValue) {
+      settings.Seed = argv[++i];
+    } else if (arg == "--shard-size" && hasValue) {
+      settings.ShardSize = std::atoi(argv[++i]);
+    } else if (arg == "--workers" && hasValue) {
+      settings.Workers = std::atoi(argv[++i]);
+    } else if (arg == "--worker") {
+      settings.Worker = true;
+    } else if (arg == "--randomization" && hasValue) {
+      settings.RandomizationPath = argv[++i];
+    } else if (arg == "--report" && hasValue) {
+      settings.ReportPath = argv[++i];
+    } else if (arg == "--resolutions") {
+      list = &settings.Resolutions;
+    } else if (arg == "--resolution" && hasValue) {
+      settings.Resolution = argv[++i];
+    } else if (arg == "--cameras") {
+      list = &settings.Cameras;
+    } else if (arg == "--models") {
+      list = &settings.Models;
+    } else if (list && arg.rfind("--", 0) != 0) {
+      list->push_back(arg);
+    } else {
+      Logger::Warn("Headless: Unknown argument " + arg);
+    }
+  }
+  return settings;
+}
+
+HeadlessApplication::HeadlessApplication(const HeadlessSettings &settings)
+    : mSettings(settings) {
+  mBaseFolders = Application::FindBaseFolders();
+  mContext = std::make_unique<Context>(mBaseFolders->Config, true);
+  // Everything below issues GL calls, Run reports the failure
+  if (!mContext->IsValid()) return;
+
+  mTextureManager = std::make_unique<TextureManager>();
+  mTextureManager->SetCache(mBaseFolders->Cache + "textures");
+  mTextureManager->SetCompression(settings.Compression);
+  mTextureManager->SetMemoryBudget(size_t(settings.TextureBudgetMB) << 20);
+  mExampleLoader = std::make_unique<ExampleLoader>(mBaseFolders->Example);
+
+  mViewport = std::make_unique<Viewport>(mBaseFolders.get());
+  mViewport->SetTextureManager(mTextureManager.get());
+  mViewport->SetExampleLoader(mExampleLoader.get());
+  if (!settings.RandomizationPath.empty()) {
+    mViewport->GetRandomizer()->LoadJson(settings.RandomizationPath);
+  }
+}
+
+void HeadlessApplication::loadScene() {
+  mViewport->SelectResolution(mSettings.Resolution);
+  if (mSettings.Cameras.empty() && mSettings.Models.empty()) {
+    Logger::Info("Headless: No scene given, loading example");
+    mViewport->LoadExample();
+  }
+  for (const std::string &camera : mSettings.Cameras)
+    mViewport->QueueCamera(camera);
+  for (const std::string &model : mSettings.Models)
+    mViewport->QueueModel(model);
+
+  while (mViewport->IsLoading()) {
+    mViewport->UpdateHeadless();
+  }
+}
+
+int HeadlessApplication::Run() {
+  if (!mContext->IsValid()) {
+    Logger::Error("Headless: No OpenGL context, is EGL or OSMesa available?");
+    return 1;
+  }
+  if (mSettings.OutputFolder.empty()) {
+    Logger::Error("Headless: Missing --output folder");
+    return 1;
+  }
+  loadScene();
+  if (mViewport->GetCameraCount() == 0) {
+    Logger::Error("Headless: No cameras loaded");
+    return 1;
+  }
+
+  FileSystem::CreateDir(mSettings.OutputFolder);
+  configureGenerator();
+
+  if (mSettings.Worker) {
+    ShardQueue queue(mSettings.OutputFolder);
+    if (!queue.Load()) return 1;
+    return runWorker(queue);
+  }
+  if (mSettings.ShardSize > 0) return runCoordinator();
+  return generate(mSettings.OutputFolder, 0, mSettings.NumRenders) ? 0 : 1;
+}
+
+void HeadlessApplication::configureGenerator() {
+  Generator *generator = mViewport->GetGenerator();
+  generator->ModifyPoseFormat() = mSettings.Poses;
+  generator->ModifyTarShardMB() = mSettings.TarShardMB;
+  generator->ModifyColorFormat() = mSettings.ColorFormat;
+  generator->ModifySegmentationFormat() = mSettings.SegmentationFormat;
+  generator->ModifyWaitForPhysics() = true;
+  if (mSettings.PhysicsWorlds > 0) {
+    generator->ModifyPhysicsWorlds() = mSettings.PhysicsWorlds;
+  }
+  if (!mSettings.Seed.empty()) {
+    generator->ModifySeed() = std::strtoull(mSettings.Seed.c_str(), nullptr, 0);
+  }
+}
+
+int HeadlessApplication::RunBenchmark() {
+  if (!mContext->IsValid()) {
+    Logger::Error("Bench: No OpenGL context, is EGL or OSMesa available?");
+    return 1;
+  }
+  if (mSettings.OutputFolder.empty()) {
+    mSettings.OutputFolder = mBaseFolders->Cache + "bench";
+  }
+  // Same scene and poses on every run so reports stay comparable
+  if (mSettings.Seed.empty()) mSettings.Seed = "1";
+  loadScene();
+  if (mViewport->GetCameraCount() == 0) {
+    Logger::Error("Bench: No cameras loaded");
+    return 1;
+  }
+  FileSystem::CreateDir(mSettings.OutputFolder);
+  configureGenerator();
+
+  std::vector<std::string> resolutions = mSettings.Resolutions;
+  if (resolutions.empty()) resolutions = mViewport->GetResolutionNames();
+  const std::vector<std::string> &names = mViewport->GetResolutionNames();
+  const std::vector<int> &heights = mViewport->GetResolutionHeights();
+
+  json report;
+  report["seed"] = mViewport->GetGenerator()->GetSeed();
+  report["cameras"] = mViewport->GetCameraCount();
+  report["samples"] = mSettings.NumRenders;
+  report["color_format"] = mSettings.ColorFormat;
+  report["segmentation_format"] = mSettings.SegmentationFormat;
+  report["resolutions"] = json::array();
+
+  StageStats::SetEnabled(true);
+  for (const std::string &name : resolutions) {
+    auto found = std::find(names.begin(), names.end(), name);
+    if (found == names.end()) {
+      Logger::Error("Bench: Unknown resolution " + name);
+      continue;
+    }
+    mViewport->SelectResolution(name);
+    // Changing the resolution re-streams every texture at the new height,
+    // wait for them so no resolution is timed with the previous images
+    while (mViewport->IsLoading()) {
+      mViewport->UpdateHeadless();
+    }
+
+    StageStats::Reset();
+    uint64_t start = Profiler::Now();
+    if (!generate(mSettings.OutputFolder + "/" + name, 0,
+                  mSettings.NumRenders)) {
+      StageStats::SetEnabled(false);
+      return 1;
+    }
+    double seconds = (Profiler::Now() - start) / 1e9;
+
+    json entry;
+    entry["name"] = name;
+    entry["height"] = heights[found - names.begin()];
+    entry["seconds"] = seconds;
+    entry["renders_per_second"] =
+        seconds > 0.0 ? mSettings.NumRenders / seconds : 0.0;
+    for (int i = 0; i < static_cast<int>(Stage::Count); i++) {
+      Stage stage = static_cast<Stage>(i);
+      StageSummary summary = StageStats::GetSummary(stage);
+      entry["stages"][StageStats::GetName(stage)] = {
+          {"count", summary.Count},     {"p50_ms", summary.P50Ms},
+          {"p99_ms", summary.P99Ms},    {"mean_ms", summary.MeanMs},
+          {"max_ms", summary.MaxMs}};
+    }
+    report["resolutions"].push_back(entry);
+    Logger::Info("Bench: " + name + " took " + std::to_string(seconds) + " s");
+  }
+  StageStats::SetEnabled(false);
+
+  std::string text = report.dump(2);
+  std::cout << text << std::endl;
+  if (!mSettings.ReportPath.empty()) {
+    std::ofstream file(mSettings.ReportPath);
+    file << text << std::endl;
+    if (!file) {
+      Logger::Error("Bench: Failed to write " + mSettings.ReportPath);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+bool HeadlessApplication::generate(const std::string &folder, int firstRender,
+                                   int numRenders,
+                                   const std::function<void()> &onFrame) {
+  Generator *generator = mViewport->GetGenerator();
+  generator->ModifyFirstRender() = firstRender;
+  generator->ModifyNumRenders() = numRenders;
+  if (!generator->Start(folder)) return false;
+  while (generator->IsRunning()) {
+    mViewport->UpdateHeadless();
+    mViewport->Render();
+    if (onFrame) onFrame();
+  }
+  glFinish();
+  return true;
+}
+
+int HeadlessApplication::runCoordinator() {
+  ShardQueue queue(mSettings.OutputFolder);
+  // Shards hold whole scenes, every camera renders each scene once
+  if (!queue.Create(mSettings.NumRenders, mSettings.ShardSize,
+                    mViewport->GetCameraCount(),
+                    mViewport->GetGenerator()->GetSeed())) {
+    return 1;
+  }
+
+  std::string command = getWorkerCommand();
+  std::vector<int> statuses(std::max(0, mSettings.Workers), 0);
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < statuses.size(); i++) {
+    workers.emplace_back([&command, &statuses, i]() {
+      statuses[i] = std::system(command.c_str());
+    });
+  }
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+  for (size_t i = 0; i < statuses.size(); i++) {
+    if (statuses[i] != 0) {
+      Logger::Warn("Headless: Worker " + std::to_string(i) + " exited with " +
+                   std::to_string(statuses[i]));
+    }
+  }
+
+  // Renders what is left and everything when no workers were started. Crashed
+  // workers are noticed by their missing heartbeat, workers on other nodes
+  // may still be rendering their claims.
+  while (true) {
+    int requeued = queue.Requeue();
+    if (requeued > 0) {
+      Logger::Warn("Headless: Rendering " + std::to_string(requeued) +
+                   " unfinished shards");
+    }
+    runWorker(queue);
+    if (queue.IsFinished()) break;
+    Logger::Info("Headless: Waiting for " +
+                 std::to_string(queue.GetClaimedCount()) +
+                 " shards claimed by other workers");
+    std::this_thread::sleep_for(
+        std::chrono::seconds(ShardQueue::HeartbeatSeconds));
+  }
+  queue.WriteManifest();
+  return queue.IsFinished() ? 0 : 1;
+}
+
+int HeadlessApplication::runWorker(ShardQueue &queue) {
+  // Every shard of a run draws from the same seed
+  mViewport->GetGenerator()->ModifySeed() = queue.GetSeed();
+  ShardRange shard;
+  while (queue.Claim(shard)) {
+    Logger::Info("Headless: Shard " + std::to_string(shard.Id) + " renders [" +
+                 std::to_string(shard.Begin) + ", " +
+                 std::to_string(shard.End) + ")");
+    // The claim of a failed shard goes stale and is requeued
+    if (!generate(queue.GetShardFolder(shard.Id), shard.Begin, shard.End,
+                  [&queue, &shard]() { queue.Heartbeat(shard); })) {
+      return 1;
+    }
+    queue.Complete(shard);
+  }
+  return 0;
+}
+
+std::string HeadlessApplication::getWorkerCommand() const {
+  std::string command = "\"" + mSettings.Executable + "\" --worker";
+  for (size_t i = 0; i < mSettings.Args.size(); i++) {
+    const std::string &arg = mSettings.Args[i];
+    // Workers take the seed and their shards from the queue
+    if (arg == "--shard-size" || arg == "--workers" || arg == "--seed") {
+      i++;
+      continue;
+    }
+    command += " \"" + arg + "\"";
+  }
+  return command;
+}
@@ -0,0 +1,79 @@
+#include "Core/ImageWriter.h"
+
+#include "Core/Logger.h"
+#include "Utilities/Profiler.h"
+#include "Utilities/StageStats.h"
+
+#include <fstream>
+#include <memory>
+
+ImageWriter::ImageWriter(int numThreads, size_t maxQueued)
+    : mPool(numThreads, maxQueued > 0 ? maxQueued : 2 * size_t(numThreads)) {
+  Logger::Debug("ImageWriter: Started " +
+                std::to_string(mPool.GetThreadCount()) + " threads");
+}
+
+void ImageWriter::Write(const std::string &path, PixelBuffer pixels,
+                        std::shared_ptr<const ImageEncoder> encoder) {
+  if (!encoder) encoder = std::make_shared<PngEncoder>();
+  // std::function needs a copyable callable, share the move-only buffer
+  auto job = std::make_shared<PixelBuffer>(std::move(pixels));
+  uint64_t queuedAt = Profiler::Now();
+  mPool.Submit([this, path, job, encoder, queuedAt]() {
+    Profiler::SetThreadName("ImageWriter");
+    std::vector<unsigned char> data;
+    uint64_t encodeStart = Profiler::Now();
+    bool saved = encoder->Encode(*job, data);
+    job->Release();
+    uint64_t writeStart = Profiler::Now();
+    StageStats::Record(Stage::Encode, encodeStart, writeStart,
+                       "ImageWriter::Encode");
+    if (!saved) {
+      Logger::Error("ImageWriter: Failed to encode " + path);
+    } else if (mSink) {
+      mSink(path, std::move(data));
+    } else {
+      std::ofstream file(path, std::ios::binary);
+      file.write(reinterpret_cast<const char *>(data.data()), data.size());
+      saved = file.good();
+      if (!saved) Logger::Error("ImageWriter: Failed to write " + path);
+    }
+    uint64_t writtenAt = Profiler::Now();
+    StageStats::Record(Stage::Write, writeStart, writtenAt,
+                       "ImageWriter::Write");
+    recordWrite((writtenAt - queuedAt) / 1e6);
+    if (saved) Logger::Info("Image saved: " + path);
+  });
+
+  int depth = static_cast<int>(mPool.GetQueued());
+  std::lock_guard<std::mutex> lock(mStatsMutex);
+  mMaxQueueDepth = std::max(mMaxQueueDepth, depth);
+}
+
+void ImageWriter::Drain() { mPool.Wait(); }
+
+void ImageWriter::recordWrite(double latencyMs) {
+  std::lock_guard<std::mutex> lock(mStatsMutex);
+  mWritten++;
+  mTotalLatencyMs += latencyMs;
+  mMaxLatencyMs = std::max(mMaxLatencyMs, latencyMs);
+}
+
+ImageWriterStats ImageWriter::GetStats() const {
+  ImageWriterStats stats;
+  stats.QueueDepth = static_cast<int>(mPool.GetQueued() + mPool.GetActive());
+  std::lock_guard<std::mutex> lock(mStatsMutex);
+  stats.Written = mWritten;
+  stats.MaxQueueDepth = mMaxQueueDepth;
+  stats.AverageLatencyMs = mWritten > 0 ? mTotalLatencyMs / mWritten : 0.0;
+  stats.MaxLatencyMs = mMaxLatencyMs;
+  return stats;
+}
+
+void ImageWriter::ResetStats() {
+  std::lock_guard<std::mutex> lock(mStatsMutex);
+  mWritten = 0;
+  mMaxQueueDepth = 0;
+  mTotalLatencyMs = 0.0;
+  mMaxLatencyMs = 0.0;
+}
@@ -0,0 +1,83 @@
+#include "Core/Loader/AssetLoader.h"
+
+#include <chrono>
+
+#include "Core/Logger.h"
+#include "Rendering/Models/Model.h"
+
+AssetLoader::AssetLoader(MeshCache *cache,
+                         const TextureManager *textureManager, int numThreads)
+    : mCache(cache), mTextureManager(textureManager), mPool(numThreads) {}
+
+void AssetLoader::SubmitModel(const std::string &path) {
+  DecodeOptions options = mTextureManager->GetDecodeOptions();
+  submit([this, path, options]() {
+    LoadedAsset asset;
+    asset.Path = path;
+    asset.IsModel = true;
+    asset.Ok = Model::Load(path, asset.Data, mCache);
+    for (const MeshData &mesh : asset.Data.Meshes) {
+      for (const std::string &texture : mesh.Textures) {
+        decodeTexture(texture, options, asset);
+      }
+    }
+    return asset;
+  });
+}
+
+void AssetLoader::SubmitTexture(const std::string &path) {
+  DecodeOptions options = mTextureManager->GetDecodeOptions();
+  submit([this, path, options]() {
+    LoadedAsset asset;
+    asset.Path = path;
+    decodeTexture(path, options, asset);
+    asset.Ok = !asset.Textures.empty();
+    return asset;
+  });
+}
+
+std::vector<LoadedAsset> AssetLoader::Poll(size_t maxAssets) {
+  std::vector<LoadedAsset> assets;
+  while (!mPending.empty() && assets.size() < maxAssets) {
+    std::future<LoadedAsset> &front = mPending.front();
+    if (front.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+      break;
+    assets.push_back(front.get());
+    mPending.pop_front();
+  }
+  // The decoded textures go to TextureManager now, which owns them from here
+  std::lock_guard<std::mutex> lock(mClaimedMutex);
+  for (const LoadedAsset &asset : assets) {
+    for (const DecodedTexture &texture : asset.Textures) {
+      mClaimed.erase(texture.Path);
+    }
+  }
+  return assets;
+}
+
+void AssetLoader::submit(std::function<LoadedAsset()> job) {
+  // ThreadPool tasks must be copyable, packaged_task is not
+  auto task =
+      std::make_shared<std::packaged_task<LoadedAsset()>>(std::move(job));
+  mPending.push_back(task->get_future());
+  mPool.Submit([task]() { (*task)(); });
+}
+
+bool AssetLoader::claimTexture(const std::string &path) {
+  std::lock_guard<std::mutex> lock(mClaimedMutex);
+  return mClaimed.insert(path).second;
+}
+
+void AssetLoader::decodeTexture(const std::string &path,
+                                const DecodeOptions &options,
+                                LoadedAsset &asset) {
+  if (!claimTexture(path)) return;
+  DecodedTexture texture;
+  if (mTextureManager->Decode(path, options, texture)) {
+    asset.Textures.push_back(std::move(texture));
+    return;
+  }
+  // Nothing to hand over, a later submit may try again
+  std::lock_guard<std::mutex> lock(mClaimedMutex);
+  mClaimed.erase(path);
+}
@@ -32,6 +32,7 @@ Logger &Logger::get() {
 }
 
 void Logger::showLogsInternal() {
+  std::lock_guard<std::mutex> lock(mMutex);
   ImGui::Begin("Logger");
   ImGui::PushTextWrapPos(ImGui::GetWindowWidth());
   for (const auto &log : mLogs) {
@@ -68,7 +69,8 @@ void Logger::log(const std::string &message, LogLevel logLevel) {
   auto info = logLevel2ColorType(logLevel);
   std::string logMessageColor =
       timeStamp + info.first + info.second + message + Colors::ANSI::RESET;
-  std::cout << logMessageColor << std::endl;
+  std::lock_guard<std::mutex> lock(mMutex);
+  *mConsole << logMessageColor << std::endl;
   std::string logMessageNoColor = timeStamp + info.second + message;
   if (mLogFile.is_open()) {
     mLogFile << logMessageNoColor << std::endl;
@@ -0,0 +1,266 @@
+#include "Core/PoseWriter.h"
+
+#include "Core/Logger.h"
+#include "Utilities/FileSystem.h"
+#include "Utilities/Profiler.h"
+#include "Utilities/Serialize.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#define SUBFOLDER_POSE_DATA "poses/"
+
+namespace {
+constexpr char MAGIC[8] = {'O', 'M', 'V', 'X', 'P', 'O', 'S', 'E'};
+// Render id and calibrated size, then tvec, rvec, intrinsics, distortion
+constexpr size_t CAMERA_BLOCK_SIZE = 3 * sizeof(int32_t) + 19 * sizeof(float);
+// Position and quaternion
+constexpr size_t BODY_BLOCK_SIZE = 7 * sizeof(float);
+// Binary records are 64 bit aligned so readers can map them as arrays
+constexpr size_t RECORD_ALIGN = 8;
+
+// Layout of a binary record in order, count values of type each
+constexpr const char *SCHEMA = R"({
+  "endian": "little",
+  "camera": [
+    {"name": "id", "type": "int32", "count": 1},
+    {"name": "calibrated_size", "type": "int32", "count": 2},
+    {"name": "tvec", "type": "float32", "count": 3},
+    {"name": "rvec", "type": "float32", "count": 3},
+    {"name": "intrinsics", "type": "float32", "count": 9, "order": "column"},
+    {"name": "distortion", "type": "float32", "count": 4}
+  ],
+  "body": [
+    {"name": "position", "type": "float32", "count": 3},
+    {"name": "quaternion", "type": "float32", "count": 4, "order": "xyzw"}
+  ],
+  "padding": "zero filled to a multiple of 8 bytes"
+})";
+
+template <typename T> void put(unsigned char *&out, T value) {
+  std::memcpy(out, &value, sizeof(T));
+  out += sizeof(T);
+}
+
+void appendFloats(std::string &line, const float *values, int count) {
+  char buffer[32];
+  line += '[';
+  for (int i = 0; i < count; i++) {
+    if (i > 0) line += ',';
+    int size = std::snprintf(buffer, sizeof(buffer), "%.9g", values[i]);
+    line.append(buffer, size);
+  }
+  line += ']';
+}
+} // namespace
+
+PoseWriter::PoseWriter(PoseFormat format, size_t syncEvery)
+    : mFormat(format), mSyncEvery(std::max<size_t>(1, syncEvery)) {}
+PoseWriter::~PoseWriter() { Close(); }
+
+bool PoseWriter::Open(const std::string &outputFolder, int bodyCount) {
+  Close();
+  mOutputFolder = outputFolder;
+  mBodyCount = bodyCount;
+  mUnsynced = 0;
+  if (mFormat == PoseFormat::Json) {
+    FileSystem::CreateDir(mOutputFolder + SUBFOLDER_POSE_DATA);
+    return true;
+  }
+
+  bool binary = mFormat == PoseFormat::Binary;
+  std::string path = mOutputFolder + (binary ? "poses.bin" : "poses.ndjson");
+  mFile = std::fopen(path.c_str(), "wb");
+  if (!mFile) {
+    Logger::Error("PoseWriter: Failed to open " + path);
+    return false;
+  }
+  // Large buffer, records reach the kernel in a few big writes per batch
+  std::setvbuf(mFile, nullptr, _IOFBF, 1 << 20);
+  if (binary) writeHeader();
+  return true;
+}
+
+void PoseWriter::Write(int renderId, const std::string &fileName,
+                       const CameraParameters &camera,
+                       const std::vector<reactphysics3d::RigidBody *> &bodies) {
+  OMVEX_PROFILE_SCOPE("PoseWriter::Write");
+  switch (mFormat) {
+  case PoseFormat::Json:
+    writeJson(fileName, camera, bodies);
+    return;
+  case PoseFormat::NDJson:
+    writeNDJson(renderId, camera, bodies);
+    break;
+  case PoseFormat::Binary:
+    writeBinary(renderId, camera, bodies);
+    break;
+  }
+  if (++mUnsynced >= mSyncEvery) sync();
+}
+
+void PoseWriter::Close() {
+  if (!mFile) return;
+  sync();
+  std::fclose(mFile);
+  mFile = nullptr;
+}
+
+bool PoseWriter::Parse(const std::string &name, PoseFormat &format) {
+  if (name == "json") {
+    format = PoseFormat::Json;
+  } else if (name == "ndjson") {
+    format = PoseFormat::NDJson;
+  } else if (name == "binary") {
+    format = PoseFormat::Binary;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+size_t PoseWriter::GetRecordSize(int bodyCount) {
+  size_t size = CAMERA_BLOCK_SIZE + BODY_BLOCK_SIZE * bodyCount;
+  return (size + RECORD_ALIGN - 1) / RECORD_ALIGN * RECORD_ALIGN;
+}
+
+void PoseWriter::writeJson(
+    const std::string &fileName, const CameraParameters &camera,
+    const std::vector<reactphysics3d::RigidBody *> &bodies) {
+  std::string path = mOutputFolder + SUBFOLDER_POSE_DATA + fileName + ".json";
+  std::ofstream outFile(path);
+  json j;
+  int id = 0;
+  for (const auto &body : bodies) {
+    const auto &transform = body->getTransform();
+    const auto &pos = transform.getPosition();
+    const auto &quat = transform.getOrientation();
+
+    j["bodies"][id]["position"] = {pos.x, pos.y, pos.z};
+    j["bodies"][id]["quaternion"] = {quat.x, quat.y, quat.z, quat.w};
+    id++;
+  }
+  Serialize::ToJson::Vec(j["camera"]["tvec"], camera.Tvec);
+  Serialize::ToJson::Vec(j["camera"]["rvec"], camera.Rvec);
+  Serialize::ToJson::Mat(j["camera"]["intrinsics"], camera.Intrinsic);
+  Serialize::ToJson::Vec(j["camera"]["distortion"], camera.Distortion);
+  Serialize::ToJson::Vec(j["camera"]["calibrated_size"],
+                         camera.ImageCalibratedSize);
+  outFile << j.dump(4);
+}
+
+void PoseWriter::FormatLine(
+    int renderId, const CameraParameters &camera,
+    const std::vector<reactphysics3d::RigidBody *> &bodies,
+    std::string &line) {
+  // Same keys as the json files plus the render id, formatted by hand so a
+  // line costs no DOM
+  line.clear();
+  line += "{\"id\":" + std::to_string(renderId) + ",\"bodies\":[";
+  for (size_t i = 0; i < bodies.size(); i++) {
+    const reactphysics3d::Transform &transform = bodies[i]->getTransform();
+    const reactphysics3d::Vector3 &pos = transform.getPosition();
+    const reactphysics3d::Quaternion &quat = transform.getOrientation();
+    float position[3] = {float(pos.x), float(pos.y), float(pos.z)};
+    float quaternion[4] = {float(quat.x), float(quat.y), float(quat.z),
+                           float(quat.w)};
+    if (i > 0) line += ',';
+    line += "{\"position\":";
+    appendFloats(line, position, 3);
+    line += ",\"quaternion\":";
+    appendFloats(line, quaternion, 4);
+    line += '}';
+  }
+  line += "],\"camera\":{\"tvec\":";
+  appendFloats(line, &camera.Tvec.x, 3);
+  line += ",\"rvec\":";
+  appendFloats(line, &camera.Rvec.x, 3);
+  line += ",\"intrinsics\":[";
+  for (int c = 0; c < 3; c++) {
+    if (c > 0) line += ',';
+    appendFloats(line, &camera.Intrinsic[c].x, 3);
+  }
+  line += "],\"distortion\":";
+  appendFloats(line, &camera.Distortion.x, 4);
+  line += ",\"calibrated_size\":[" +
+          std::to_string(camera.ImageCalibratedSize.x) + "," +
+          std::to_string(camera.ImageCalibratedSize.y) + "]}}\n";
+}
+
+void PoseWriter::writeNDJson(
+    int renderId, const CameraParameters &camera,
+    const std::vector<reactphysics3d::RigidBody *> &bodies) {
+  FormatLine(renderId, camera, bodies, mLine);
+  std::fwrite(mLine.data(), 1, mLine.size(), mFile);
+}
+
+void PoseWriter::writeBinary(
+    int renderId, const CameraParameters &camera,
+    const std::vector<reactphysics3d::RigidBody *> &bodies) {
+  if (static_cast<int>(bodies.size()) != mBodyCount) {
+    Logger::Error("PoseWriter: Body count changed while writing");
+    return;
+  }
+  mRecord.assign(GetRecordSize(mBodyCount), 0);
+  unsigned char *out = mRecord.data();
+  put<int32_t>(out, renderId);
+  put<int32_t>(out, camera.ImageCalibratedSize.x);
+  put<int32_t>(out, camera.ImageCalibratedSize.y);
+  for (int i = 0; i < 3; i++)
+    put<float>(out, camera.Tvec[i]);
+  for (int i = 0; i < 3; i++)
+    put<float>(out, camera.Rvec[i]);
+  for (int c = 0; c < 3; c++) {
+    for (int r = 0; r < 3; r++)
+      put<float>(out, camera.Intrinsic[c][r]);
+  }
+  for (int i = 0; i < 4; i++)
+    put<float>(out, camera.Distortion[i]);
+  for (const reactphysics3d::RigidBody *body : bodies) {
+    const reactphysics3d::Transform &transform = body->getTransform();
+    const reactphysics3d::Vector3 &pos = transform.getPosition();
+    const reactphysics3d::Quaternion &quat = transform.getOrientation();
+    put<float>(out, pos.x);
+    put<float>(out, pos.y);
+    put<float>(out, pos.z);
+    put<float>(out, quat.x);
+    put<float>(out, quat.y);
+    put<float>(out, quat.z);
+    put<float>(out, quat.w);
+  }
+  std::fwrite(mRecord.data(), 1, mRecord.size(), mFile);
+}
+
+void PoseWriter::writeHeader() {
+  // Magic, version, body count, record size, schema size, schema, then
+  // padding so the first record is aligned
+  uint32_t schemaSize = static_cast<uint32_t>(std::strlen(SCHEMA));
+  uint32_t fields[4] = {Version, static_cast<uint32_t>(mBodyCount),
+                        static_cast<uint32_t>(GetRecordSize(mBodyCount)),
+                        schemaSize};
+  std::fwrite(MAGIC, 1, sizeof(MAGIC), mFile);
+  std::fwrite(fields, sizeof(uint32_t), 4, mFile);
+  std::fwrite(SCHEMA, 1, schemaSize, mFile);
+  size_t headerSize = sizeof(MAGIC) + sizeof(fields) + schemaSize;
+  static const char zeros[RECORD_ALIGN] = {};
+  size_t padding = (RECORD_ALIGN - headerSize % RECORD_ALIGN) % RECORD_ALIGN;
+  std::fwrite(zeros, 1, padding, mFile);
+}
+
+void PoseWriter::sync() {
+  if (!mFile) return;
+  std::fflush(mFile);
+#ifdef _WIN32
+  _commit(_fileno(mFile));
+#else
+  fsync(fileno(mFile));
+#endif
+  mUnsynced = 0;
+}
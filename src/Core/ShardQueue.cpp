@@ -0,0 +1,245 @@
+#include "Core/ShardQueue.h"
+
+#include "Core/Logger.h"
+#include "Utilities/FileSystem.h"
+#include "Utilities/Serialize.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+constexpr auto STATE_PENDING = "pending";
+constexpr auto STATE_CLAIMED = "claimed";
+constexpr auto STATE_DONE = "done";
+
+std::string padId(int id) {
+  std::ostringstream oss;
+  oss << std::setfill('0') << std::setw(5) << id;
+  return oss.str();
+}
+// "<host> <pid>" of this process, written into its claims
+std::string getOwner() {
+#ifdef _WIN32
+  const char *host = std::getenv("COMPUTERNAME");
+  std::string name = host ? host : "unknown";
+  int processId = _getpid();
+#else
+  char host[256] = {};
+  gethostname(host, sizeof(host) - 1);
+  std::string name = host[0] ? host : "unknown";
+  int processId = static_cast<int>(getpid());
+#endif
+  return name + " " + std::to_string(processId);
+}
+std::string readOwner(const std::string &path) {
+  ShardRange shard;
+  std::string host, processId;
+  std::ifstream file(path);
+  file >> shard.Id >> shard.Begin >> shard.End >> host >> processId;
+  return host.empty() ? "unknown" : host + ":" + processId;
+}
+bool readEntry(const std::string &path, ShardRange &shard) {
+  std::ifstream file(path);
+  return static_cast<bool>(file >> shard.Id >> shard.Begin >> shard.End);
+}
+} // namespace
+
+ShardQueue::ShardQueue(const std::string &outputFolder)
+    : mOutputFolder(outputFolder + "/"),
+      mQueueFolder(outputFolder + "/queue/") {}
+
+bool ShardQueue::Create(int numRenders, int shardSize, int align,
+                        uint64_t seed) {
+  align = std::max(1, align);
+  shardSize = std::max(1, shardSize);
+  shardSize = (shardSize + align - 1) / align * align;
+  mSeed = seed;
+  mNumRenders = numRenders;
+  mShardSize = shardSize;
+
+  std::error_code error;
+  std::filesystem::remove_all(mQueueFolder, error);
+  FileSystem::CreateDir(mQueueFolder + STATE_PENDING);
+  FileSystem::CreateDir(mQueueFolder + STATE_CLAIMED);
+  FileSystem::CreateDir(mQueueFolder + STATE_DONE);
+
+  json j;
+  j["seed"] = mSeed;
+  j["num_renders"] = mNumRenders;
+  j["shard_size"] = mShardSize;
+  std::ofstream runFile(mQueueFolder + "run.json");
+  runFile << j.dump(4);
+  if (!runFile) {
+    Logger::Error("ShardQueue: Failed to write " + mQueueFolder + "run.json");
+    return false;
+  }
+  runFile.close();
+
+  int id = 0;
+  for (int begin = 0; begin < numRenders; begin += shardSize, id++) {
+    std::ofstream entry(getEntryPath(STATE_PENDING, id));
+    int end = std::min(numRenders, begin + shardSize);
+    entry << id << " " << begin << " " << end;
+  }
+  Logger::Info("ShardQueue: " + std::to_string(id) + " shards of " +
+               std::to_string(shardSize) + " renders");
+  return true;
+}
+
+bool ShardQueue::Load() {
+  std::ifstream runFile(mQueueFolder + "run.json");
+  if (!runFile) {
+    Logger::Error("ShardQueue: No run in " + mQueueFolder);
+    return false;
+  }
+  json j = json::parse(runFile, nullptr, false);
+  if (j.is_discarded()) {
+    Logger::Error("ShardQueue: Failed to parse " + mQueueFolder + "run.json");
+    return false;
+  }
+  mSeed = j.value("seed", uint64_t(0));
+  mNumRenders = j.value("num_renders", 0);
+  mShardSize = j.value("shard_size", 0);
+  return true;
+}
+
+bool ShardQueue::Claim(ShardRange &shard) {
+  for (const ShardRange &pending : list(STATE_PENDING)) {
+    std::error_code error;
+    std::filesystem::rename(getEntryPath(STATE_PENDING, pending.Id),
+                            getEntryPath(STATE_CLAIMED, pending.Id), error);
+    // Another worker renamed it first
+    if (error) continue;
+    shard = pending;
+    // Rewriting the entry also starts its heartbeat
+    std::ofstream entry(getEntryPath(STATE_CLAIMED, shard.Id));
+    entry << shard.Id << " " << shard.Begin << " " << shard.End << " "
+          << getOwner();
+    mLastHeartbeat = std::chrono::steady_clock::now();
+    return true;
+  }
+  return false;
+}
+
+void ShardQueue::Complete(const ShardRange &shard) {
+  std::error_code error;
+  std::filesystem::rename(getEntryPath(STATE_CLAIMED, shard.Id),
+                          getEntryPath(STATE_DONE, shard.Id), error);
+  if (error) {
+    Logger::Error("ShardQueue: Failed to complete shard " +
+                  std::to_string(shard.Id) + ", " + error.message());
+  }
+}
+
+void ShardQueue::Heartbeat(const ShardRange &shard) {
+  auto now = std::chrono::steady_clock::now();
+  if (now - mLastHeartbeat < std::chrono::seconds(HeartbeatSeconds)) return;
+  mLastHeartbeat = now;
+  touch(getEntryPath(STATE_CLAIMED, shard.Id));
+}
+
+int ShardQueue::Requeue(int staleSeconds) {
+  int count = 0;
+  auto now = std::filesystem::file_time_type::clock::now();
+  for (const ShardRange &claimed : list(STATE_CLAIMED)) {
+    std::string path = getEntryPath(STATE_CLAIMED, claimed.Id);
+    std::error_code error;
+    auto written = std::filesystem::last_write_time(path, error);
+    if (error || now - written < std::chrono::seconds(staleSeconds)) continue;
+    std::string owner = readOwner(path);
+    std::filesystem::rename(path, getEntryPath(STATE_PENDING, claimed.Id),
+                            error);
+    if (error) continue;
+    Logger::Warn("ShardQueue: Shard " + std::to_string(claimed.Id) +
+                 " of " + owner + " has no heartbeat, requeued");
+    count++;
+  }
+  return count;
+}
+
+int ShardQueue::GetClaimedCount() const {
+  return static_cast<int>(list(STATE_CLAIMED).size());
+}
+
+void ShardQueue::touch(const std::string &path) const {
+  std::error_code error;
+  std::filesystem::last_write_time(
+      path, std::filesystem::file_time_type::clock::now(), error);
+  if (error) {
+    Logger::Warn("ShardQueue: Heartbeat failed for " + path + ", " +
+                 error.message());
+  }
+}
+
+bool ShardQueue::IsFinished() const {
+  return list(STATE_PENDING).empty() && list(STATE_CLAIMED).empty();
+}
+
+bool ShardQueue::WriteManifest() const {
+  std::vector<ShardRange> shards = list(STATE_DONE);
+  json j;
+  j["seed"] = mSeed;
+  j["num_renders"] = mNumRenders;
+  j["complete"] = IsFinished();
+  j["shards"] = json::array();
+  for (const ShardRange &shard : shards) {
+    std::string folder = "shard_" + padId(shard.Id);
+    j["shards"].push_back(
+        {{"id", shard.Id}, {"begin", shard.Begin}, {"end", shard.End},
+         {"folder", folder}});
+  }
+
+  // Every shard writes the same labels, keep one copy at the top
+  if (!shards.empty()) {
+    std::string first = GetShardFolder(shards.front().Id);
+    for (const char *name : {"labels.json", "model_names.txt"}) {
+      std::error_code error;
+      std::filesystem::copy_file(
+          first + "/" + name, mOutputFolder + name,
+          std::filesystem::copy_options::overwrite_existing, error);
+    }
+  }
+
+  std::ofstream file(mOutputFolder + "manifest.json");
+  file << j.dump(4);
+  if (!file) {
+    Logger::Error("ShardQueue: Failed to write manifest");
+    return false;
+  }
+  Logger::Info("ShardQueue: Manifest lists " + std::to_string(shards.size()) +
+               " shards");
+  return true;
+}
+
+std::string ShardQueue::GetShardFolder(int id) const {
+  return mOutputFolder + "shard_" + padId(id);
+}
+
+std::string ShardQueue::getEntryPath(const std::string &state, int id) const {
+  return mQueueFolder + state + "/" + padId(id);
+}
+
+std::vector<ShardRange> ShardQueue::list(const std::string &state) const {
+  std::vector<ShardRange> shards;
+  std::error_code error;
+  for (const auto &entry :
+       std::filesystem::directory_iterator(mQueueFolder + state, error)) {
+    ShardRange shard;
+    if (readEntry(entry.path().string(), shard)) shards.push_back(shard);
+  }
+  std::sort(shards.begin(), shards.end(),
+            [](const ShardRange &a, const ShardRange &b) {
+              return a.Id < b.Id;
+            });
+  return shards;
+}
@@ -0,0 +1,159 @@
+#include "Core/TarWriter.h"
+
+#include "Core/Logger.h"
+#include "Utilities/FileSystem.h"
+#include "Utilities/Serialize.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+constexpr size_t BLOCK_SIZE = 512;
+
+std::string shardName(int shard) {
+  std::ostringstream oss;
+  oss << "data-" << std::setfill('0') << std::setw(6) << shard << ".tar";
+  return oss.str();
+}
+
+void putOctal(char *field, size_t width, uint64_t value) {
+  // width - 1 digits and a terminating NUL
+  std::snprintf(field, width, "%0*llo", static_cast<int>(width - 1),
+                static_cast<unsigned long long>(value));
+}
+} // namespace
+
+TarWriter::TarWriter(const std::string &folder, size_t shardBytes,
+                     int partsPerSample)
+    : mFolder(folder), mShardBytes(std::max<size_t>(BLOCK_SIZE, shardBytes)),
+      mPartsPerSample(std::max(1, partsPerSample)) {
+  FileSystem::CreateDir(mFolder);
+}
+TarWriter::~TarWriter() { Close(); }
+
+void TarWriter::Add(const std::string &key, const std::string &part,
+                    std::vector<unsigned char> data) {
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (mClosed) {
+    Logger::Error("TarWriter: Add after close, " + key + "." + part);
+    return;
+  }
+  std::vector<Part> &parts = mPending[key];
+  parts.push_back({part, std::move(data)});
+  if (static_cast<int>(parts.size()) < mPartsPerSample) return;
+  writeSample(key, parts);
+  mPending.erase(key);
+}
+
+void TarWriter::Close() {
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (mClosed) return;
+  mClosed = true;
+  if (!mPending.empty()) {
+    Logger::Warn("TarWriter: Writing " + std::to_string(mPending.size()) +
+                 " incomplete samples");
+  }
+  for (auto &[key, parts] : mPending) {
+    writeSample(key, parts);
+  }
+  mPending.clear();
+  closeShard();
+  writeIndex();
+}
+
+void TarWriter::writeSample(const std::string &key, std::vector<Part> &parts) {
+  // Samples never span shards, a new one starts once the current is full
+  if (mFile && mOffset >= mShardBytes) closeShard();
+  if (!mFile && !openShard()) return;
+
+  // Arrival order depends on the encoders, keep members in a stable order
+  std::sort(parts.begin(), parts.end(),
+            [](const Part &a, const Part &b) { return a.Name < b.Name; });
+  mIndex.push_back({key, mShard, mOffset});
+  for (const Part &part : parts) {
+    writeMember(key + "." + part.Name, part.Data);
+  }
+  mShardSamples[mShard]++;
+}
+
+bool TarWriter::openShard() {
+  mShard++;
+  std::string path = mFolder + shardName(mShard);
+  mFile = std::fopen(path.c_str(), "wb");
+  if (!mFile) {
+    Logger::Error("TarWriter: Failed to open " + path);
+    mShard--;
+    return false;
+  }
+  std::setvbuf(mFile, nullptr, _IOFBF, 1 << 20);
+  mOffset = 0;
+  mShardSizes.push_back(0);
+  mShardSamples.push_back(0);
+  return true;
+}
+
+void TarWriter::closeShard() {
+  if (!mFile) return;
+  // End of archive, two zero blocks
+  static const char zeros[BLOCK_SIZE * 2] = {};
+  std::fwrite(zeros, 1, sizeof(zeros), mFile);
+  mOffset += sizeof(zeros);
+  mShardSizes[mShard] = mOffset;
+  std::fclose(mFile);
+  mFile = nullptr;
+  Logger::Info("TarWriter: Closed " + shardName(mShard));
+}
+
+void TarWriter::writeMember(const std::string &name,
+                            const std::vector<unsigned char> &data) {
+  // ustar header, fixed uid, gid and mtime so equal runs give equal shards
+  char header[BLOCK_SIZE] = {};
+  if (name.size() >= 100) {
+    Logger::Warn("TarWriter: Name too long, truncated " + name);
+  }
+  std::memcpy(header, name.data(), std::min<size_t>(name.size(), 99));
+  putOctal(header + 100, 8, 0644);
+  putOctal(header + 108, 8, 0);
+  putOctal(header + 116, 8, 0);
+  putOctal(header + 124, 12, data.size());
+  putOctal(header + 136, 12, 0);
+  header[156] = '0';
+  std::memcpy(header + 257, "ustar", 6);
+  std::memcpy(header + 263, "00", 2);
+
+  // Checksum is taken with its own field filled with spaces
+  std::memset(header + 148, ' ', 8);
+  unsigned int checksum = 0;
+  for (unsigned char c : header)
+    checksum += c;
+  std::snprintf(header + 148, 8, "%06o", checksum);
+  header[155] = ' ';
+
+  std::fwrite(header, 1, BLOCK_SIZE, mFile);
+  std::fwrite(data.data(), 1, data.size(), mFile);
+  static const char zeros[BLOCK_SIZE] = {};
+  size_t padding = (BLOCK_SIZE - data.size() % BLOCK_SIZE) % BLOCK_SIZE;
+  std::fwrite(zeros, 1, padding, mFile);
+  mOffset += BLOCK_SIZE + data.size() + padding;
+}
+
+void TarWriter::writeIndex() const {
+  json j;
+  j["shards"] = json::array();
+  for (size_t i = 0; i < mShardSizes.size(); i++) {
+    j["shards"].push_back({{"file", shardName(static_cast<int>(i))},
+                           {"samples", mShardSamples[i]},
+                           {"bytes", mShardSizes[i]}});
+  }
+  // [key, shard, offset of the first member header]
+  j["samples"] = json::array();
+  for (const IndexEntry &entry : mIndex) {
+    j["samples"].push_back({entry.Key, entry.Shard, entry.Offset});
+  }
+  std::ofstream file(mFolder + "index.json");
+  file << j.dump();
+  if (!file) Logger::Error("TarWriter: Failed to write index");
+}
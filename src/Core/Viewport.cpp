@@ -2,23 +2,32 @@
 
 #include "Utilities/FileSystem.h"
 #include "Utilities/ImGuiHelpers.h"
+#include "Utilities/Profiler.h"
 #include "Utilities/Random.h"
+#include "Utilities/StageStats.h"
 
 Viewport::Viewport(BaseFolders *folders) {
   mBaseFolders = folders;
   mViewMode = std::make_unique<ViewMode>(ViewMode::Color);
   mBgQuad = std::make_unique<Quad>();
-  mDimQuad = std::make_unique<Quad>();
+  mPostQuad = std::make_unique<Quad>();
+  mRandomizer = std::make_unique<DomainRandomizer>();
   mModelManager = std::make_unique<ModelManager>();
   mPhysicsManager = std::make_unique<PhysicsManager>();
   mCameraManager = std::make_unique<CameraManager>();
+  mMeshCache = std::make_unique<MeshCache>(mBaseFolders->Cache + "meshes");
   mRenderer = std::make_unique<Renderer>(mBaseFolders->Shaders);
-  mGenerator =
-      std::make_unique<Generator>(mCameraManager.get(), mModelManager.get(),
-                                  mPhysicsManager.get(), mViewMode.get());
+  mGenerator = std::make_unique<Generator>(
+      mCameraManager.get(), mModelManager.get(), mPhysicsManager.get());
   Logger::Success("Viewport initialized");
 }
 
+void Viewport::SetTextureManager(TextureManager *tm) {
+  mTextureManager = tm;
+  mTextureManager->SetTargetHeight(mResolutionHeights[mCurrentResolution]);
+  mAssetLoader = std::make_unique<AssetLoader>(mMeshCache.get(), tm);
+}
+
 void Viewport::OnActivate() { Logger::Info("Viewport activated"); }
 void Viewport::OnDeactivate() { Logger::Info("Viewport deactivated"); }
 void Viewport::RenderUI() {
@@ -44,7 +53,7 @@ void Viewport::RenderUI() {
       ImGui::EndMenu();
     }
     if (ImGui::BeginMenu("Help")) {
-      if (ImGui::MenuItem("Example")) loadExample();
+      if (ImGui::MenuItem("Example")) LoadExample();
       ImGui::EndMenu();
     }
     ImGui::EndMainMenuBar();
@@ -67,12 +76,15 @@ void Viewport::updateMain(const ImVec2 &windowSize) {
 }
 void Viewport::renderMain() {
   if (mFrameBuffer) {
+    // Instance ids are not displayable, show the colorized preview instead
+    Texture *texture = *mViewMode == ViewMode::Segmentation
+                           ? mRenderer->GetSegmentationPreview()
+                           : mFrameBuffer->GetColorTexture(TargetColor);
     ImGui::SetCursorPos(mImageOffset);
-    mFrameBuffer->ColorTexture->Bind();
-    ImGui::Image(
-        (ImTextureID)(intptr_t)mFrameBuffer->ColorTexture->GetTextureID(),
-        ImVec2(mImageSize.x, mImageSize.y));
-    mFrameBuffer->ColorTexture->Unbind();
+    texture->Bind();
+    ImGui::Image((ImTextureID)(intptr_t)texture->GetTextureID(),
+                 ImVec2(mImageSize.x, mImageSize.y));
+    texture->Unbind();
   } else {
     ImGuiHelpers::CenterText("You need to add camera");
   }
@@ -112,13 +124,43 @@ void Viewport::handleSettings() {
 
   if (ImGui::Button("Simulate") && mPhysicsManager->GetBodyCount() > 0)
     mPhysicsManager->Simulate();
+  ImGui::InputInt("PhysicsWorlds", &mGenerator->ModifyPhysicsWorlds());
+  if (ImGui::IsItemHovered()) {
+    ImGui::SetTooltip("Number of physics worlds settled in parallel while "
+                      "rendering.");
+  }
   ImGui::Separator();
   ImGui::Text("Renderer");
-  ImGui::SliderFloat("MaxDim", &mMaxDim, 0.0f, 1.0f);
+  RandomizationSettings &randomization = mRandomizer->ModifySettings();
+  ImGui::SliderFloat("MaxDim", &randomization.Dim.y, 0.0f, 1.0f);
   if (ImGui::IsItemHovered()) {
     ImGui::SetTooltip("This slider controls the maximum dimming effect on the "
                       "image. Higher values make the image darker.");
   }
+  if (ImGui::CollapsingHeader("Randomization")) {
+    ImGui::SliderInt2("Lights", &randomization.LightCount.x, 0, MAX_LIGHTS);
+    ImGui::DragFloat2("Elevation", &randomization.LightElevation.x, 1.0f,
+                      0.0f, 90.0f);
+    ImGui::DragFloat2("Intensity", &randomization.LightIntensity.x, 0.01f,
+                      0.0f, 4.0f);
+    ImGui::DragFloat2("Warmth", &randomization.LightWarmth.x, 0.01f, -1.0f,
+                      1.0f);
+    ImGui::DragFloat2("Ambient", &randomization.Ambient.x, 0.01f, 0.0f, 2.0f);
+    ImGui::DragFloat2("Tint", &randomization.Tint.x, 0.01f, 0.0f, 2.0f);
+    ImGui::DragFloat2("Noise", &randomization.Noise.x, 0.001f, 0.0f, 0.5f);
+    ImGui::DragFloat2("Blur", &randomization.Blur.x, 0.05f, 0.0f, 8.0f);
+    ImGui::DragFloat2("Exposure", &randomization.Exposure.x, 0.01f, -4.0f,
+                      4.0f);
+    if (ImGui::IsItemHovered()) {
+      ImGui::SetTooltip("Each pair is the {min, max} range a rendered image "
+                        "samples its value from.");
+    }
+  }
+  ImGui::InputScalar("Seed", ImGuiDataType_U64, &mGenerator->ModifySeed());
+  if (ImGui::IsItemHovered()) {
+    ImGui::SetTooltip("Runs with the same seed and scene render the same "
+                      "dataset.");
+  }
   ImGui::InputInt("Renders", &mGenerator->ModifyNumRenders());
   if (ImGui::IsItemHovered()) {
     ImGui::SetTooltip("This input sets number of images to be rendered");
@@ -139,7 +181,6 @@ void Viewport::handleSettings() {
 void Viewport::handleDebug() {
   ImGui::Begin("Debug", nullptr, ImGuiWindowFlags_NoResize);
   ImGui::Text("Active Folder: %s", mBaseFolders->Active.c_str());
-  ImGui::Text("mDim: %f", mDim);
   ImGui::Text("mImageResolutionHeight: %i",
               mResolutionHeights[mCurrentResolution]);
   ImGui::Separator();
@@ -154,6 +195,34 @@ void Viewport::handleDebug() {
   ImGui::Text("CameraManager: ");
   ImGui::Text(" -Count: %i", mCameraManager->GetCount());
   ImGui::Text(" -SelectedID: %i", mCameraManager->GetSelectedId());
+  ImGui::Separator();
+  ImageWriterStats writerStats = mGenerator->GetWriterStats();
+  ImGui::Text("ImageWriter: ");
+  ImGui::Text(" -QueueDepth: %i", writerStats.QueueDepth);
+  ImGui::Text(" -Written: %i", writerStats.Written);
+  ImGui::Text(" -AvgLatency: %.1f ms", writerStats.AverageLatencyMs);
+  ImGui::Text(" -MaxLatency: %.1f ms", writerStats.MaxLatencyMs);
+  ImGui::Separator();
+  const TextureStats &textureStats = mTextureManager->GetStats();
+  ImGui::Text("TextureManager: ");
+  ImGui::Text(" -Count: %zu", textureStats.Count);
+  ImGui::Text(" -Memory: %.1f MB", textureStats.Bytes / (1024.0 * 1024.0));
+  ImGui::Text(" -Hits/Misses: %zu / %zu", textureStats.Hits,
+              textureStats.Misses);
+  ImGui::Text(" -Evictions: %zu", textureStats.Evictions);
+  ImGui::Text(" -Streaming: %zu", mTextureManager->GetPending());
+  ImGui::Separator();
+#ifdef OMVEX_PROFILING
+  Profiler::Collect();
+  ImGui::Text("Profiler (avg / max of the last second, ms): ");
+  for (const ProfileStat &stat : Profiler::GetStats()) {
+    ImGui::Text(" -%s%s: %.2f / %.2f", stat.Gpu ? "GPU " : "",
+                stat.Name.c_str(), stat.AverageMs, stat.MaxMs);
+  }
+#else
+  ImGui::Text("Profiler: Compiled out");
+#endif
+  ImGui::Separator();
   if (mCamera) {
     ImGui::Text("Camera:");
     ImGui::Text(" -Resolution: %s: %i, %i",
@@ -166,15 +235,54 @@ void Viewport::handleDebug() {
 }
 
 void Viewport::Render() {
-  mRenderer->Begin(mCamera, mFrameBuffer, mViewMode.get(), mBgQuad.get());
-
-  for (size_t i = 0; i < mModelManager->GetCount(); i++) {
-    Model *model = mModelManager->GetModel(i);
-    glm::vec3 color = mModelManager->GetSegmentedColors()[i];
-    mRenderer->RenderModel(mCamera, mFrameBuffer, mViewMode.get(), model,
-                           color);
+  OMVEX_PROFILE_SCOPE("Viewport::Render");
+  // Timestamps of earlier frames, without waiting for the current one
+  Profiler::PollGpu();
+  mRenderer->UpdateScene(mModelManager->GetModels(),
+                         mModelManager->GetRevision());
+  if (mGenerator->IsRunning()) {
+    renderAllCameras();
+  } else {
+    renderCamera();
+  }
+  if (*mViewMode == ViewMode::Segmentation) {
+    mRenderer->RenderSegmentationPreview(mFrameBuffer, mPostQuad.get(),
+                                         mModelManager->GetCount());
+  }
+}
+void Viewport::renderCamera() {
+  if (!mCamera || !mFrameBuffer) return;
+  // Looked up every frame, an unpinned background may have been evicted
+  mBgTexture = mTextureManager->GetTextureAsync(mCamera->GetBgImage());
+  mBgQuad->SetTexture(mBgTexture);
+  // Preview shows the strongest dimming without any other randomization
+  float dim = mRandomizer->GetSettings().Dim.y;
+  mRenderer->SetRandomization(DomainRandomizer::Neutral(dim));
+  mRenderer->Begin(mCamera, mFrameBuffer, mBgQuad.get());
+  mRenderer->RenderScene(mCamera, mFrameBuffer);
+  mRenderer->End(mPostQuad.get(), mFrameBuffer);
+}
+void Viewport::renderAllCameras() {
+  // CPU time to submit every view, the GPU finishes them asynchronously
+  StageStats::Scope timer(Stage::Render, "Viewport::renderAllCameras");
+  // Every camera sees the same poses, render them all in one frame instead
+  // of switching cameras between samples
+  std::vector<std::unique_ptr<Camera>> &cameras = mCameraManager->GetCameras();
+  std::vector<std::unique_ptr<FBO>> &fbos = mCameraManager->GetFBOs();
+  std::vector<RenderView> views(cameras.size());
+  for (size_t i = 0; i < cameras.size(); i++) {
+    views[i].Cam = cameras[i].get();
+    views[i].Target = fbos[i].get();
+    views[i].Background =
+        mTextureManager->GetTextureAsync(cameras[i]->GetBgImage());
+    Random::Stream rng(mGenerator->GetSeed(), mGenerator->GetSceneIndex(),
+                       Random::Purpose::Randomization, i);
+    views[i].Randomization = mRandomizer->Sample(rng);
   }
-  mRenderer->End(mDimQuad.get(), mDim, mViewMode.get(), mFrameBuffer);
+  mRenderer->RenderViews(views, mBgQuad.get(), mPostQuad.get());
+  // Placeholders are only swapped in Update, none pending means every view
+  // was drawn with its real textures
+  mViewsComplete = mTextureManager->GetPending() == 0;
 }
 
 void Viewport::Update() {
@@ -184,15 +292,17 @@ void Viewport::Update() {
   handleDebug();
   Logger::ShowLogs();
 
-  if (mGenerator->IsRunning() && !mPhysicsManager->IsSimulating() &&
-      mGenerator->NeedSim()) {
-    mPhysicsManager->Simulate();
-  }
-  if (!mGenerator->IsRunning()) mDim = mMaxDim;
+  updateScene();
+}
+
+void Viewport::UpdateHeadless() {
+  handleLoad();
+  updateScene();
+}
+
+void Viewport::updateScene() {
   mPhysicsManager->Update(mModelManager->GetModels());
-  if (mGenerator->IsRunning() && !mPhysicsManager->IsSimulating())
-    mDim = Random::Float(0.0f, mMaxDim);
-  if (!mPhysicsManager->IsSimulating()) {
+  if (!mPhysicsManager->IsSimulating() && mViewsComplete) {
     mGenerator->Update();
   }
 
@@ -205,12 +315,30 @@ void Viewport::handleResolutionChange() {
   for (size_t i = 0; i < mResolutionNames.size(); i++) {
     if (ImGui::MenuItem(mResolutionNames[i].c_str(), NULL,
                         mCurrentResolution == i)) {
-      mCurrentResolution = static_cast<int>(i);
-      mCameraManager->ChangeResolution(mResolutionHeights[mCurrentResolution]);
-      Logger::Debug("Resolution changed to: " +
-                    mResolutionNames[mCurrentResolution]);
+      setResolution(static_cast<int>(i));
+    }
+  }
+}
+bool Viewport::SelectResolution(const std::string &name) {
+  for (size_t i = 0; i < mResolutionNames.size(); i++) {
+    if (mResolutionNames[i] == name) {
+      setResolution(static_cast<int>(i));
+      return true;
     }
   }
+  Logger::Error("Unknown resolution: " + name);
+  return false;
+}
+void Viewport::setResolution(int id) {
+  mCurrentResolution = id;
+  mCameraManager->ChangeResolution(mResolutionHeights[mCurrentResolution]);
+  if (mTextureManager) {
+    mTextureManager->SetTargetHeight(mResolutionHeights[mCurrentResolution]);
+    // Resident backgrounds and materials were sized for the old height
+    mTextureManager->Invalidate();
+  }
+  Logger::Debug("Resolution changed to: " +
+                mResolutionNames[mCurrentResolution]);
 }
 
 void Viewport::removeCamera() {
@@ -223,7 +351,7 @@ void Viewport::switchCamFBO() {
   mFrameBuffer = mCameraManager->GetFBO();
   if (!mCamera || !mFrameBuffer) return;
 
-  mBgTexture = mTextureManager->GetTexture(mCamera->GetBgImage());
+  mBgTexture = mTextureManager->GetTextureAsync(mCamera->GetBgImage());
   mBgQuad->SetTexture(mBgTexture);
   Logger::Debug("Switch to camera " + mCamera->GetBgImage());
 }
@@ -244,9 +372,7 @@ void Viewport::handleOpenModel() {
     if (!modelFilePath.empty()) mModelLoadingQueue.push(modelFilePath);
   }
 }
-void Viewport::addModel(const std::string &modelPath) {
-  std::unique_ptr<Model> model =
-      std::make_unique<Model>(modelPath, mTextureManager);
+void Viewport::addModel(std::unique_ptr<Model> model) {
   mPhysicsManager->AddModel(model.get());
   mModelManager->AddModel(std::move(model));
 }
@@ -257,20 +383,42 @@ void Viewport::removeModel() {
 }
 
 void Viewport::handleLoad() {
-  if (!mCameraLoadingQueue.empty()) {
+  // Cameras are cheap to create, their backgrounds decode on the loader
+  while (!mCameraLoadingQueue.empty()) {
     const std::string cameraPath = mCameraLoadingQueue.front();
     mCameraLoadingQueue.pop();
     mCameraManager->AddCameraFBO(cameraPath,
                                  mResolutionHeights[mCurrentResolution]);
-    return;
+    const std::string &bgImage =
+        mCameraManager->GetCameras().back()->GetBgImage();
+    if (!bgImage.empty() && !mTextureManager->Has(bgImage)) {
+      mAssetLoader->SubmitTexture(bgImage);
+    }
   }
-  if (!mModelLoadingQueue.empty()) {
-    const std::string modelPath = mModelLoadingQueue.front();
+  while (!mModelLoadingQueue.empty()) {
+    mAssetLoader->SubmitModel(mModelLoadingQueue.front());
     mModelLoadingQueue.pop();
-    addModel(modelPath);
+  }
+  uploadAssets();
+  mTextureManager->Update();
+}
+void Viewport::uploadAssets() {
+  // A few assets per frame keeps the GL upload step short
+  const size_t maxAssetsPerFrame = 4;
+  for (LoadedAsset &asset : mAssetLoader->Poll(maxAssetsPerFrame)) {
+    for (DecodedTexture &texture : asset.Textures) {
+      mTextureManager->AddTexture(texture);
+    }
+    if (!asset.IsModel) continue;
+    if (!asset.Ok) {
+      Logger::Error("Failed to load model: " + asset.Path);
+      continue;
+    }
+    addModel(std::make_unique<Model>(asset.Path, std::move(asset.Data),
+                                     mTextureManager));
   }
 }
-void Viewport::loadExample() {
+void Viewport::LoadExample() {
   mExampleLoader->LoadCameras(mCameraLoadingQueue);
   mExampleLoader->LoadModels(mModelLoadingQueue);
 }
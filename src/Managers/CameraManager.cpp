@@ -1,5 +1,6 @@
 #include "Managers/CameraManager.h"
 
+#include "Rendering/Shaders/Renderer.h"
 #include "Utilities/FileSystem.h"
 #include "Utilities/ImGuiHelpers.h"
 
@@ -17,7 +18,8 @@ void CameraManager::AddCameraFBO(const std::string &paramPath, int height) {
   std::unique_ptr<Camera> camera =
       std::make_unique<Camera>(width, height, glm::vec3(0.0f));
   camera->SetParameters(folderPath, params);
-  std::unique_ptr<FBO> fbo = std::make_unique<FBO>(width, height);
+  std::unique_ptr<FBO> fbo = std::make_unique<FBO>(width, height,
+                                                   Renderer::TargetFormats());
 
   std::string name = "Camera " + std::to_string(GetCount()) + " " + paramPath;
   mCameras.push_back(std::move(camera));
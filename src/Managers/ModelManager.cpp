@@ -1,7 +1,6 @@
 #include "Managers/ModelManager.h"
 
 #include "Utilities/FileSystem.h"
-#include "Utilities/Colors.h"
 #include "Utilities/ImGuiHelpers.h"
 
 #include <imgui.h>
@@ -15,9 +14,8 @@ void ModelManager::AddModel(std::unique_ptr<Model> model) {
       FileSystem::RemoveFileExtension(model->GetPath()));
   mModels.push_back(std::move(model));
   mModelNames.push_back(name);
-  mModelSegmentedColors =
-      Colors::GenerateSegmentedColors(static_cast<int>(mModels.size()));
   mSelectedId = static_cast<int>(mModels.size()) - 1;
+  mRevision++;
   Logger::Info("ModelManager: Added model " + name);
 }
 
@@ -30,10 +28,10 @@ void ModelManager::Remove(int id) {
 
   mModels.erase(mModels.begin() + id);
   mModelNames.erase(mModelNames.begin() + id);
+  mRevision++;
 
   if (!mModels.empty()) {
     mSelectedId = std::min(mSelectedId, GetCount() - 1);
-    mModelSegmentedColors = Colors::GenerateSegmentedColors(GetCount());
   } else {
     mSelectedId = -1;
   }
@@ -0,0 +1,124 @@
+#include "Managers/PhysicsBatch.h"
+
+#include "Core/Logger.h"
+#include "Utilities/Profiler.h"
+#include "Utilities/StageStats.h"
+
+#include <algorithm>
+
+PhysicsBatch::PhysicsBatch(int numWorlds, uint64_t seed, size_t maxQueued)
+    : mSeed(seed), mMaxQueued(maxQueued) {
+  numWorlds = std::max(1, numWorlds);
+  if (mMaxQueued == 0) mMaxQueued = static_cast<size_t>(numWorlds) * 2;
+  for (int i = 0; i < numWorlds; i++) {
+    mWorlds.push_back(std::make_unique<PhysicsManager>());
+  }
+  mPool = std::make_unique<ThreadPool>(numWorlds);
+}
+PhysicsBatch::~PhysicsBatch() { Stop(); }
+
+void PhysicsBatch::SetBodies(const std::vector<std::unique_ptr<Model>> &models,
+                             float spawningSpace) {
+  if (mRunning) {
+    Logger::Warn("PhysicsBatch: Cannot change bodies while running");
+    return;
+  }
+  for (std::unique_ptr<PhysicsManager> &world : mWorlds) {
+    while (world->GetBodyCount() > 0) {
+      world->RemoveBody(world->GetBodyCount() - 1);
+    }
+    for (const std::unique_ptr<Model> &model : models) {
+      world->AddModel(model.get());
+    }
+    world->ModSpawningSpace() = spawningSpace;
+  }
+}
+
+void PhysicsBatch::Start(int64_t firstIndex) {
+  if (mRunning) return;
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mQueue.clear();
+    mNextPop = firstIndex;
+  }
+  mNextIndex = firstIndex;
+  mRunning = true;
+  for (int i = 0; i < GetWorldCount(); i++) {
+    mPool->Submit([this, i]() { runWorld(i); });
+  }
+  Logger::Info("PhysicsBatch: Started " + std::to_string(GetWorldCount()) +
+               " worlds");
+}
+void PhysicsBatch::Stop() {
+  if (!mRunning) return;
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mRunning = false;
+  }
+  mSceneAvailable.notify_all();
+  mSpaceAvailable.notify_all();
+  mPool->Wait();
+  std::lock_guard<std::mutex> lock(mMutex);
+  mQueue.clear();
+}
+
+bool PhysicsBatch::Pop(SettledScene &scene) {
+  std::unique_lock<std::mutex> lock(mMutex);
+  auto next = mQueue.end();
+  mSceneAvailable.wait(lock, [this, &next]() {
+    next = mQueue.find(mNextPop);
+    return next != mQueue.end() || !mRunning;
+  });
+  if (next == mQueue.end()) return false;
+  pop(lock, next, scene);
+  return true;
+}
+
+bool PhysicsBatch::TryPop(SettledScene &scene) {
+  std::unique_lock<std::mutex> lock(mMutex);
+  auto next = mQueue.find(mNextPop);
+  if (next == mQueue.end()) return false;
+  pop(lock, next, scene);
+  return true;
+}
+
+void PhysicsBatch::pop(std::unique_lock<std::mutex> &lock,
+                       std::map<int64_t, SettledScene>::iterator next,
+                       SettledScene &scene) {
+  scene = std::move(next->second);
+  mQueue.erase(next);
+  mNextPop++;
+  lock.unlock();
+  // The window moved, any waiting world may now fit
+  mSpaceAvailable.notify_all();
+}
+
+size_t PhysicsBatch::GetQueued() const {
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mQueue.size();
+}
+
+void PhysicsBatch::runWorld(int id) {
+  PhysicsManager *world = mWorlds[id].get();
+  Profiler::SetThreadName("Physics");
+  while (mRunning) {
+    SettledScene scene;
+    scene.Index = mNextIndex++;
+    scene.World = id;
+    Random::Stream rng(mSeed, scene.Index, Random::Purpose::Pose);
+    {
+      StageStats::Scope timer(Stage::Settle, "PhysicsManager::SimulateToRest");
+      scene.Result = world->SimulateToRest(world->GetMaxSteps(), rng);
+    }
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mSpaceAvailable.wait(lock, [this, &scene]() {
+      return scene.Index < mNextPop + static_cast<int64_t>(mMaxQueued) ||
+             !mRunning;
+    });
+    if (!mRunning) return;
+    mQueue.emplace(scene.Index, std::move(scene));
+    lock.unlock();
+    mSceneAvailable.notify_one();
+  }
+}
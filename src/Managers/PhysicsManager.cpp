@@ -1,11 +1,23 @@
 #include "Managers/PhysicsManager.h"
 
+#include "Utilities/Profiler.h"
 #include "Utilities/Random.h"
 #include "Utilities/ReactPhysicsHelpers.h"
 
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+// Hull points of every mesh keyed by model path, shared by all worlds so the
+// hulls are only computed from the full meshes once
+std::unordered_map<std::string, std::vector<std::vector<float>>> hullCache;
+std::mutex hullCacheMutex;
+} // namespace
+
 PhysicsManager::PhysicsManager() {
   reactphysics3d::PhysicsWorld::WorldSettings settings;
-  settings.defaultVelocitySolverNbIterations = 20;
+  settings.defaultVelocitySolverNbIterations =
+      mSettling.GetSettings().MaxIterations;
   settings.isSleepingEnabled = true;
   settings.gravity =
       reactphysics3d::Vector3(0, 0, reactphysics3d::decimal(-9.81));
@@ -25,10 +37,14 @@ PhysicsManager::PhysicsManager() {
 }
 
 void PhysicsManager::AddModel(Model *model) {
-  glm::vec3 half = (model->GetMaxVert() - model->GetMinVert()) / 2.0f;
   auto *body =
       createRigidBody(reactphysics3d::BodyType::DYNAMIC, defaultTransform());
-  attachBoxCollider(body, {half.x, half.y, half.z});
+  if (!attachConvexColliders(body, model)) {
+    glm::vec3 half = (model->GetMaxVert() - model->GetMinVert()) / 2.0f;
+    attachBoxCollider(body, {half.x, half.y, half.z});
+    Logger::Warn("PhysicsManager: Using box collider for " + model->GetPath());
+  }
+  body->updateMassPropertiesFromColliders();
   Logger::Debug("PhysicsManager: Added body " + model->GetPath());
 }
 
@@ -47,17 +63,22 @@ void PhysicsManager::addGroundPlane() {
   attachBoxCollider(mGround, {1000, 1000, 1});
   Logger::Debug("PhysicsManager: Added ground plane");
 }
-void PhysicsManager::randomizeTransforms() {
+void PhysicsManager::randomizeTransforms(Random::Stream &rng) {
+  // Deactivating drops the broad phase pairs and their cached contacts, so
+  // a drop only depends on its start poses and not on the previous one
+  for (reactphysics3d::RigidBody *body : mBodies) {
+    body->setIsActive(false);
+  }
   for (size_t i = 0; i < mBodies.size(); i++) {
     reactphysics3d::RigidBody *body = mBodies[i];
-    glm::vec2 pos = Random::Vec2(-mSpawningSpace, mSpawningSpace);
+    glm::vec2 pos = Random::Vec2(-mSpawningSpace, mSpawningSpace, rng);
 
     const reactphysics3d::AABB aabb = body->getAABB();
     reactphysics3d::Vector3 extents = aabb.getMax() - aabb.getMin();
     float z = glm::max(extents.x, glm::max(extents.y, extents.z));
 
     reactphysics3d::Vector3 position = reactphysics3d::Vector3(pos.x, pos.y, z);
-    reactphysics3d::Quaternion orientation = Random::RandomQuaternion();
+    reactphysics3d::Quaternion orientation = Random::RandomQuaternion(rng);
     reactphysics3d::Transform transform(position, orientation);
 
     body->setTransform(transform);
@@ -69,32 +90,75 @@ void PhysicsManager::randomizeTransforms() {
 
 void PhysicsManager::Update(std::vector<std::unique_ptr<Model>> &models) {
   if (!mSimulating) return;
+  OMVEX_PROFILE_SCOPE("PhysicsManager::Update");
 
   // Initialize random transforms
   if (mSimulationFrame == 0) {
-    randomizeTransforms();
+    randomizeTransforms(Random::ThreadStream());
     Logger::Info("Resimulate");
   }
   // Do physics
+  bool sleep = step();
+  syncModels(models);
+  mSimulationFrame++;
+  // Stop simulating if all bodies are sleeping or max simulation frames reached
+  if (sleep || (mSimulationFrame >= mSimulatingFrames)) {
+    mSimulating = false;
+  }
+}
+
+bool PhysicsManager::step() {
   constexpr float fixedTimeStep = 1.0f / 60.0f;
   mPhysicsWorld->update(fixedTimeStep);
-  bool sleep = true;
-  for (size_t i = 0; i < mBodies.size(); i++) {
-    const reactphysics3d::RigidBody *body = mBodies[i];
-    const auto &transform = body->getTransform();
+  for (const reactphysics3d::RigidBody *body : mBodies) {
+    if (!body->isSleeping()) return false;
+  }
+  return true;
+}
+void PhysicsManager::syncModels(
+    std::vector<std::unique_ptr<Model>> &models) const {
+  for (size_t i = 0; i < mBodies.size() && i < models.size(); i++) {
+    const auto &transform = mBodies[i]->getTransform();
     const auto &position = transform.getPosition();
     const auto &rot = transform.getOrientation().getMatrix();
-    glm::mat4 mat = ReactMat3Vec3ToGlmMat4(rot, position);
-    models[i]->SetModelMatrix(mat);
-    if (!mBodies[i]->isSleeping()) {
-      sleep = false;
+    models[i]->SetModelMatrix(ReactMat3Vec3ToGlmMat4(rot, position));
+  }
+}
+
+SimulationResult PhysicsManager::SimulateToRest(int maxSteps,
+                                                Random::Stream rng) {
+  SimulationResult result;
+  randomizeTransforms(rng);
+  mSettling.Reset(mPhysicsWorld.get(), mBodies.size());
+  while (result.Steps < maxSteps) {
+    result.Steps++;
+    if (step()) {
+      result.Reason = StopReason::Sleep;
+      break;
+    }
+    if (mSettling.Update(mPhysicsWorld.get(), mBodies)) {
+      result.Reason = StopReason::Settled;
+      break;
     }
   }
-  mSimulationFrame++;
-  // Stop simulating if all bodies are sleeping or max simulation frames reached
-  if (sleep || (mSimulationFrame >= mSimulatingFrames)) {
-    mSimulating = false;
+  result.Transforms = GetTransforms();
+  return result;
+}
+std::vector<reactphysics3d::Transform> PhysicsManager::GetTransforms() const {
+  std::vector<reactphysics3d::Transform> transforms;
+  transforms.reserve(mBodies.size());
+  for (const reactphysics3d::RigidBody *body : mBodies) {
+    transforms.push_back(body->getTransform());
   }
+  return transforms;
+}
+void PhysicsManager::SetTransforms(
+    const std::vector<reactphysics3d::Transform> &transforms,
+    std::vector<std::unique_ptr<Model>> &models) {
+  for (size_t i = 0; i < mBodies.size() && i < transforms.size(); i++) {
+    mBodies[i]->setTransform(transforms[i]);
+  }
+  syncModels(models);
 }
 
 reactphysics3d::Transform PhysicsManager::defaultTransform() const {
@@ -119,3 +183,66 @@ void PhysicsManager::attachBoxCollider(
   auto *boxShape = mPhysicsCommon->createBoxShape(halfExtents);
   body->addCollider(boxShape, reactphysics3d::Transform::identity());
 }
+bool PhysicsManager::attachConvexColliders(reactphysics3d::RigidBody *body,
+                                           Model *model) {
+  const std::vector<std::vector<float>> &hulls = getHullPoints(model);
+  bool attached = false;
+  for (const std::vector<float> &points : hulls) {
+    reactphysics3d::ConvexMesh *mesh = createConvexMesh(points);
+    if (!mesh) continue;
+    auto *shape = mPhysicsCommon->createConvexMeshShape(mesh);
+    body->addCollider(shape, reactphysics3d::Transform::identity());
+    attached = true;
+  }
+  return attached;
+}
+const std::vector<std::vector<float>> &
+PhysicsManager::getHullPoints(Model *model) {
+  std::lock_guard<std::mutex> lock(hullCacheMutex);
+  auto it = hullCache.find(model->GetPath());
+  if (it != hullCache.end()) return it->second;
+
+  std::vector<std::vector<float>> hulls;
+  for (const Mesh &mesh : model->GetMeshes()) {
+    std::vector<float> points;
+    points.reserve(mesh.GetVertices().size() * 3);
+    for (const Vertex &vertex : mesh.GetVertices()) {
+      points.push_back(vertex.Position.x);
+      points.push_back(vertex.Position.y);
+      points.push_back(vertex.Position.z);
+    }
+    reactphysics3d::ConvexMesh *convexMesh = createConvexMesh(points);
+    if (!convexMesh) continue;
+
+    // Keep only the hull vertices, later worlds rebuild from these
+    std::vector<float> hull;
+    for (uint32_t i = 0; i < convexMesh->getNbVertices(); i++) {
+      const reactphysics3d::Vector3 &v = convexMesh->getVertex(i);
+      hull.insert(hull.end(), {v.x, v.y, v.z});
+    }
+    mPhysicsCommon->destroyConvexMesh(convexMesh);
+    hulls.push_back(std::move(hull));
+  }
+  Logger::Debug("PhysicsManager: Built " + std::to_string(hulls.size()) +
+                " convex hulls for " + model->GetPath());
+  return hullCache.emplace(model->GetPath(), std::move(hulls)).first->second;
+}
+reactphysics3d::ConvexMesh *
+PhysicsManager::createConvexMesh(const std::vector<float> &points) {
+  // A hull needs at least a tetrahedron
+  if (points.size() < 12) return nullptr;
+
+  reactphysics3d::VertexArray vertexArray(
+      points.data(), 3 * sizeof(float),
+      static_cast<reactphysics3d::uint32>(points.size() / 3),
+      reactphysics3d::VertexArray::DataType::VERTEX_FLOAT_TYPE);
+  std::vector<reactphysics3d::Message> messages;
+  reactphysics3d::ConvexMesh *mesh =
+      mPhysicsCommon->createConvexMesh(vertexArray, messages);
+  for (const reactphysics3d::Message &message : messages) {
+    if (message.type == reactphysics3d::Message::Type::Error) {
+      Logger::Warn("PhysicsManager: " + message.text);
+    }
+  }
+  return mesh;
+}
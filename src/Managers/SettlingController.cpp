@@ -0,0 +1,67 @@
+#include "Managers/SettlingController.h"
+
+SettlingController::SettlingController(const SettlingSettings &settings)
+    : mSettings(settings), mIterations(settings.MaxIterations) {}
+
+void SettlingController::Reset(reactphysics3d::PhysicsWorld *world,
+                               size_t numBodies) {
+  mSlowSteps.assign(numBodies, 0);
+  mStableSteps = 0;
+  mEnergy = 0.0f;
+  setIterations(world, mSettings.MaxIterations);
+}
+
+bool SettlingController::Update(
+    reactphysics3d::PhysicsWorld *world,
+    const std::vector<reactphysics3d::RigidBody *> &bodies) {
+  if (mSlowSteps.size() != bodies.size()) mSlowSteps.assign(bodies.size(), 0);
+
+  float energy = 0.0f;
+  float totalMass = 0.0f;
+  bool resting = true;
+  for (size_t i = 0; i < bodies.size(); i++) {
+    const reactphysics3d::RigidBody *body = bodies[i];
+    const reactphysics3d::Vector3 &linear = body->getLinearVelocity();
+    const reactphysics3d::Vector3 &angular = body->getAngularVelocity();
+
+    // Rotational energy uses the body space inertia tensor
+    reactphysics3d::Vector3 local =
+        body->getTransform().getOrientation().getInverse() * angular;
+    const reactphysics3d::Vector3 &inertia = body->getLocalInertiaTensor();
+    float mass = body->getMass();
+    energy += 0.5f * mass * linear.lengthSquare();
+    energy += 0.5f * (inertia.x * local.x * local.x +
+                      inertia.y * local.y * local.y +
+                      inertia.z * local.z * local.z);
+    totalMass += mass;
+
+    bool slow = body->isSleeping() ||
+                (linear.length() < mSettings.LinearSpeed &&
+                 angular.length() < mSettings.AngularSpeed);
+    mSlowSteps[i] = slow ? mSlowSteps[i] + 1 : 0;
+    if (mSlowSteps[i] < mSettings.Window) resting = false;
+  }
+  mEnergy = totalMass > 0.0f ? energy / totalMass : 0.0f;
+
+  // Stable contacts converge with fewer iterations, go back up if the pile
+  // starts moving again
+  if (mEnergy < mSettings.StableEnergy) {
+    mStableSteps++;
+    if (mStableSteps >= mSettings.StableSteps) {
+      setIterations(world, mSettings.MinIterations);
+    }
+  } else {
+    mStableSteps = 0;
+    if (mEnergy > mSettings.StableEnergy * 10.0f) {
+      setIterations(world, mSettings.MaxIterations);
+    }
+  }
+  return resting;
+}
+
+void SettlingController::setIterations(reactphysics3d::PhysicsWorld *world,
+                                       int iterations) {
+  if (!world || iterations == mIterations) return;
+  world->setNbIterationsVelocitySolver(iterations);
+  mIterations = iterations;
+}
@@ -0,0 +1,211 @@
+#include "Managers/TextureManager.h"
+
+#include "Core/Logger.h"
+
+#include <algorithm>
+
+namespace {
+// Box filter, every source pixel lands in exactly one destination pixel
+PixelBuffer downscale(const PixelBuffer &pixels, int height) {
+  int srcWidth = pixels.GetWidth();
+  int srcHeight = pixels.GetHeight();
+  int channels = pixels.GetChannels();
+  int width = std::max(1, (srcWidth * height + srcHeight / 2) / srcHeight);
+  std::vector<unsigned char> data(size_t(width) * height * channels);
+  const unsigned char *src = pixels.GetData();
+
+  std::vector<int> sum(channels);
+  for (int y = 0; y < height; y++) {
+    int y0 = y * srcHeight / height;
+    int y1 = std::max(y0 + 1, (y + 1) * srcHeight / height);
+    for (int x = 0; x < width; x++) {
+      int x0 = x * srcWidth / width;
+      int x1 = std::max(x0 + 1, (x + 1) * srcWidth / width);
+      std::fill(sum.begin(), sum.end(), 0);
+      for (int sy = y0; sy < y1; sy++) {
+        const unsigned char *row = src + size_t(sy) * srcWidth * channels;
+        for (int sx = x0; sx < x1; sx++) {
+          for (int c = 0; c < channels; c++) sum[c] += row[sx * channels + c];
+        }
+      }
+      int count = (y1 - y0) * (x1 - x0);
+      unsigned char *out = data.data() + (size_t(y) * width + x) * channels;
+      for (int c = 0; c < channels; c++) out[c] = (sum[c] + count / 2) / count;
+    }
+  }
+  return PixelBuffer(width, height, channels, 1, std::move(data));
+}
+} // namespace
+
+TextureManager::TextureManager(int decodeThreads)
+    : mUpload(std::make_unique<TextureUpload>()), mPool(decodeThreads) {}
+
+Texture *TextureManager::GetTexture(const std::string &path) {
+  // Check if the texture is already loaded
+  if (Texture *texture = find(path)) return texture;
+
+  // Load the texture if not already loaded
+  Logger::Info("TextureManager: Loading and caching new texture: " + path);
+  return insert(path, std::make_unique<Texture>(path));
+}
+
+Texture *TextureManager::GetTextureAsync(const std::string &path) {
+  if (Texture *texture = find(path)) return texture;
+
+  Texture *texture = insertPlaceholder(path);
+  stream(path);
+  return texture;
+}
+
+void TextureManager::stream(const std::string &path) {
+  uint64_t generation = mGeneration;
+  DecodeOptions options = GetDecodeOptions();
+  mPool.Submit([this, path, options, generation]() {
+    DecodedTexture decoded;
+    Decode(path, options, decoded);
+    std::lock_guard<std::mutex> lock(mDecodedMutex);
+    // Decoded at a target height that changed since, Invalidate queued the
+    // path again
+    if (generation != mGeneration) return;
+    mDecoded.push_back(std::move(decoded));
+  });
+}
+
+void TextureManager::Invalidate() {
+  {
+    std::lock_guard<std::mutex> lock(mDecodedMutex);
+    mGeneration++;
+    mDecoded.clear();
+  }
+  for (const auto &[path, entry] : mTextures) {
+    mStreaming.insert(path);
+    stream(path);
+  }
+  Logger::Debug("TextureManager: Restreaming " +
+                std::to_string(mTextures.size()) + " textures at height " +
+                std::to_string(mTargetHeight));
+}
+
+Texture *TextureManager::AddTexture(const DecodedTexture &texture) {
+  // Decoded before the target height changed, stream it at the new one
+  if (texture.TargetHeight != mTargetHeight) {
+    return GetTextureAsync(texture.Path);
+  }
+  auto it = mTextures.find(texture.Path);
+  // Compressed images only have the upload path, start from a placeholder
+  Texture *target = it != mTextures.end() ? it->second.Tex.get()
+                                          : insertPlaceholder(texture.Path);
+  if (mStreaming.count(texture.Path) && texture.GetSize() > 0) {
+    upload(texture);
+  }
+  return target;
+}
+
+bool TextureManager::Decode(const std::string &path,
+                            const DecodeOptions &options,
+                            DecodedTexture &texture) const {
+  texture.Path = path;
+  int height = options.TargetHeight;
+  texture.TargetHeight = height;
+  TextureCompression mode = options.Compression;
+  if (mCache && mCache->Load(path, height, mode, texture)) return true;
+
+  if (!Texture::Decode(path, texture.Pixels)) return false;
+  if (height > 0 && texture.Pixels.GetHeight() > height) {
+    texture.Pixels = downscale(texture.Pixels, height);
+  }
+  if (mode != TextureCompression::None) {
+    texture.Compressed = BlockCompression::Encode(texture.Pixels, mode);
+    if (texture.IsCompressed()) texture.Pixels = PixelBuffer();
+  }
+  if (mCache) mCache->Save(path, height, mode, texture);
+  return true;
+}
+
+void TextureManager::Update() {
+  std::vector<DecodedTexture> decoded;
+  {
+    std::lock_guard<std::mutex> lock(mDecodedMutex);
+    decoded.swap(mDecoded);
+  }
+
+  // Stay within the byte budget, the rest waits for the next frame
+  size_t uploaded = 0;
+  size_t i = 0;
+  for (; i < decoded.size() && uploaded < mUploadBudget; i++) {
+    DecodedTexture &texture = decoded[i];
+    if (!mStreaming.count(texture.Path)) continue;
+    if (texture.GetSize() == 0) {
+      // Decode logged the error, keep the placeholder
+      mStreaming.erase(texture.Path);
+      continue;
+    }
+    upload(texture);
+    uploaded += texture.GetSize();
+  }
+  if (i < decoded.size()) {
+    std::lock_guard<std::mutex> lock(mDecodedMutex);
+    mDecoded.insert(mDecoded.end(),
+                    std::make_move_iterator(decoded.begin() + i),
+                    std::make_move_iterator(decoded.end()));
+  }
+  evict();
+}
+
+Texture *TextureManager::find(const std::string &path) {
+  auto it = mTextures.find(path);
+  if (it == mTextures.end()) {
+    mStats.Misses++;
+    return nullptr;
+  }
+  mStats.Hits++;
+  mRecent.splice(mRecent.begin(), mRecent, it->second.Recent);
+  return it->second.Tex.get();
+}
+
+Texture *TextureManager::insert(const std::string &path,
+                                std::unique_ptr<Texture> texture) {
+  Texture *rawTexture = texture.get();
+  mRecent.push_front(path);
+  mTextures[path] = {std::move(texture), mRecent.begin()};
+  mStats.Bytes += rawTexture->GetByteSize();
+  mStats.Count = mTextures.size();
+  return rawTexture;
+}
+
+Texture *TextureManager::insertPlaceholder(const std::string &path) {
+  // Single black texel until the real image arrives
+  std::vector<unsigned char> black = {0, 0, 0, 255};
+  PixelBuffer placeholder(1, 1, 4, 1, std::move(black));
+  mStreaming.insert(path);
+  return insert(path, std::make_unique<Texture>(path, placeholder));
+}
+
+void TextureManager::evict() {
+  if (mMemoryBudget == 0) return;
+  auto it = mRecent.end();
+  while (mStats.Bytes > mMemoryBudget && it != mRecent.begin()) {
+    --it;
+    Entry &entry = mTextures[*it];
+    // Pinned textures are in use, streaming ones are still being decoded
+    if (entry.Tex->IsPinned() || mStreaming.count(*it)) continue;
+    mStats.Bytes -= entry.Tex->GetByteSize();
+    mStats.Evictions++;
+    mTextures.erase(*it);
+    it = mRecent.erase(it);
+  }
+  mStats.Count = mTextures.size();
+}
+
+void TextureManager::upload(const DecodedTexture &texture) {
+  Texture *target = mTextures[texture.Path].Tex.get();
+  mStats.Bytes -= target->GetByteSize();
+  if (texture.IsCompressed()) {
+    mUpload->Upload(*target, texture.Compressed);
+  } else {
+    mUpload->Upload(*target, texture.Pixels);
+  }
+  mStats.Bytes += target->GetByteSize();
+  mStreaming.erase(texture.Path);
+  Logger::Debug("TextureManager: Streamed texture " + texture.Path);
+}
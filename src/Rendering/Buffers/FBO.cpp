@@ -2,7 +2,8 @@
 
 #include "Core/Logger.h"
 
-FBO::FBO(int width, int height) {
+FBO::FBO(int width, int height, const std::vector<TextureFormat> &formats)
+    : mFormats(formats) {
   glGenFramebuffers(1, &ID);
   recreateFramebuffer(width, height);
 }
@@ -16,21 +17,44 @@ void FBO::Delete() {
   if (ID != 0) glDeleteFramebuffers(1, &ID);
 }
 
+void FBO::DrawToAll() const {
+  std::vector<GLenum> buffers(mFormats.size());
+  for (size_t i = 0; i < mFormats.size(); i++) {
+    buffers[i] = GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(i);
+  }
+  glDrawBuffers(static_cast<GLsizei>(buffers.size()), buffers.data());
+}
+void FBO::DrawTo(int attachment) const {
+  glDrawBuffer(GL_COLOR_ATTACHMENT0 + attachment);
+}
+
+Texture *FBO::GetColorTexture(int attachment) const {
+  if (attachment < 0 || attachment >= static_cast<int>(ColorTextures.size()))
+    return nullptr;
+  return ColorTextures[attachment].get();
+}
+
 void FBO::Resize(int newWidth, int newHeight) {
   recreateFramebuffer(newWidth, newHeight);
 }
 
 void FBO::recreateFramebuffer(int width, int height) {
   Bind();
-  createColorAttachment(width, height);
+  createColorAttachments(width, height);
   createDepthStencilAttachment(width, height);
+  DrawToAll();
   checkComplete();
   Unbind();
 }
-void FBO::createColorAttachment(int width, int height) {
-  ColorTexture = std::make_unique<Texture>(width, height);
-  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
-                         ColorTexture->GetTextureID(), 0);
+void FBO::createColorAttachments(int width, int height) {
+  ColorTextures.clear();
+  for (size_t i = 0; i < mFormats.size(); i++) {
+    ColorTextures.push_back(
+        std::make_unique<Texture>(width, height, mFormats[i]));
+    glFramebufferTexture2D(GL_FRAMEBUFFER,
+                           GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(i),
+                           GL_TEXTURE_2D, ColorTextures[i]->GetTextureID(), 0);
+  }
 }
 void FBO::createDepthStencilAttachment(int width, int height) {
   if (DepthStencilID != 0) {
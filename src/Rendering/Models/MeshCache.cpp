@@ -0,0 +1,182 @@
+#include "Rendering/Models/MeshCache.h"
+
+#include "Core/Logger.h"
+#include "Utilities/CacheFile.h"
+#include "Utilities/FileSystem.h"
+#include "Utilities/MappedFile.h"
+
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+
+namespace {
+constexpr char MAGIC[8] = {'O', 'M', 'V', 'X', 'M', 'E', 'S', 'H'};
+constexpr size_t ALIGNMENT = 16;
+
+struct CacheHeader {
+  char Magic[8];
+  uint32_t Version;
+  uint32_t VertexSize;
+  uint64_t SourceSize;
+  int64_t SourceTime;
+  uint64_t SourceHash;
+  uint32_t MeshCount;
+  uint32_t Padding;
+  float MinVert[3];
+  float MaxVert[3];
+};
+
+// Offsets are from the start of the file
+struct CacheMesh {
+  uint64_t VertexOffset;
+  uint64_t VertexCount;
+  uint64_t IndexOffset;
+  uint64_t IndexCount;
+  uint64_t TextureOffset;
+  uint64_t TextureCount;
+};
+
+size_t align(size_t offset) {
+  return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+template <typename T>
+void append(std::vector<unsigned char> &buffer, const T *data, size_t count) {
+  const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data);
+  buffer.insert(buffer.end(), bytes, bytes + count * sizeof(T));
+}
+} // namespace
+
+MeshCache::MeshCache(const std::string &folder) : mFolder(folder) {
+  if (!mFolder.empty()) FileSystem::CreateDir(mFolder);
+}
+
+std::string MeshCache::cachePath(const std::string &path) const {
+  std::string absolute = std::filesystem::absolute(path).string();
+  return CacheFile::GetPath(mFolder, absolute, ".mesh");
+}
+
+bool MeshCache::Load(const std::string &path, ModelData &data) const {
+  std::string target = cachePath(path);
+  MappedFile file(target);
+  if (!file.IsOpen() || file.GetSize() < sizeof(CacheHeader)) return false;
+  const unsigned char *bytes = file.GetData();
+  size_t size = file.GetSize();
+
+  CacheHeader header;
+  std::memcpy(&header, bytes, sizeof(header));
+  if (std::memcmp(header.Magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      header.Version != Version || header.VertexSize != sizeof(Vertex)) {
+    return false;
+  }
+
+  bool touched = false;
+  if (!CacheFile::IsSourceUnchanged(path, header.SourceSize, header.SourceTime,
+                                    header.SourceHash, touched)) {
+    return false;
+  }
+
+  size_t tableEnd =
+      sizeof(CacheHeader) + size_t(header.MeshCount) * sizeof(CacheMesh);
+  if (tableEnd > size) return false;
+
+  ModelData result;
+  result.MinVert = glm::vec3(header.MinVert[0], header.MinVert[1],
+                             header.MinVert[2]);
+  result.MaxVert = glm::vec3(header.MaxVert[0], header.MaxVert[1],
+                             header.MaxVert[2]);
+  result.Meshes.resize(header.MeshCount);
+  for (uint32_t i = 0; i < header.MeshCount; i++) {
+    CacheMesh entry;
+    std::memcpy(&entry, bytes + sizeof(CacheHeader) + i * sizeof(CacheMesh),
+                sizeof(entry));
+    if (entry.VertexOffset + entry.VertexCount * sizeof(Vertex) > size ||
+        entry.IndexOffset + entry.IndexCount * sizeof(GLuint) > size) {
+      return false;
+    }
+    // Blobs sit at aligned offsets, Mesh keeps CPU copies for the physics
+    // hulls and the merged scene buffers, so they are copied straight out
+    // of the mapping once
+    MeshData &mesh = result.Meshes[i];
+    const Vertex *vertices =
+        reinterpret_cast<const Vertex *>(bytes + entry.VertexOffset);
+    mesh.Vertices.assign(vertices, vertices + entry.VertexCount);
+    const GLuint *indices =
+        reinterpret_cast<const GLuint *>(bytes + entry.IndexOffset);
+    mesh.Indices.assign(indices, indices + entry.IndexCount);
+
+    size_t offset = entry.TextureOffset;
+    for (uint64_t t = 0; t < entry.TextureCount; t++) {
+      uint32_t length = 0;
+      if (offset + sizeof(length) > size) return false;
+      std::memcpy(&length, bytes + offset, sizeof(length));
+      offset += sizeof(length);
+      if (offset + length > size) return false;
+      mesh.Textures.emplace_back(
+          reinterpret_cast<const char *>(bytes + offset), length);
+      offset += length;
+    }
+  }
+  file.Close();
+  // Store the new time of a touched source so later loads skip the hash
+  if (touched) {
+    CacheFile::WriteAt(target, offsetof(CacheHeader, SourceTime),
+                       &header.SourceTime, sizeof(header.SourceTime));
+  }
+  data = std::move(result);
+  return true;
+}
+
+bool MeshCache::Save(const std::string &path, const ModelData &data) const {
+  CacheHeader header = {};
+  std::memcpy(header.Magic, MAGIC, sizeof(MAGIC));
+  header.Version = Version;
+  header.VertexSize = sizeof(Vertex);
+  if (!CacheFile::GetSourceInfo(path, header.SourceSize, header.SourceTime) ||
+      !CacheFile::HashSource(path, header.SourceHash)) {
+    return false;
+  }
+  header.MeshCount = static_cast<uint32_t>(data.Meshes.size());
+  for (int i = 0; i < 3; i++) {
+    header.MinVert[i] = data.MinVert[i];
+    header.MaxVert[i] = data.MaxVert[i];
+  }
+
+  // Header and mesh table first, blobs follow at aligned offsets
+  std::vector<CacheMesh> table(data.Meshes.size());
+  std::vector<unsigned char> buffer(
+      align(sizeof(CacheHeader) + table.size() * sizeof(CacheMesh)), 0);
+  for (size_t i = 0; i < data.Meshes.size(); i++) {
+    const MeshData &mesh = data.Meshes[i];
+    table[i].VertexOffset = buffer.size();
+    table[i].VertexCount = mesh.Vertices.size();
+    append(buffer, mesh.Vertices.data(), mesh.Vertices.size());
+    buffer.resize(align(buffer.size()), 0);
+
+    table[i].IndexOffset = buffer.size();
+    table[i].IndexCount = mesh.Indices.size();
+    append(buffer, mesh.Indices.data(), mesh.Indices.size());
+    buffer.resize(align(buffer.size()), 0);
+
+    table[i].TextureOffset = buffer.size();
+    table[i].TextureCount = mesh.Textures.size();
+    for (const std::string &texture : mesh.Textures) {
+      uint32_t length = static_cast<uint32_t>(texture.size());
+      append(buffer, &length, 1);
+      append(buffer, texture.data(), texture.size());
+    }
+    buffer.resize(align(buffer.size()), 0);
+  }
+  std::memcpy(buffer.data(), &header, sizeof(header));
+  if (!table.empty()) {
+    std::memcpy(buffer.data() + sizeof(header), table.data(),
+                table.size() * sizeof(CacheMesh));
+  }
+
+  std::string target = cachePath(path);
+  if (!CacheFile::WriteAtomic(target, buffer)) {
+    Logger::Warn("MeshCache: Failed to write " + target);
+    return false;
+  }
+  return true;
+}
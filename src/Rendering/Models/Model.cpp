@@ -2,15 +2,33 @@
 
 #include "Utilities/FileSystem.h"
 
-Model::Model(const std::string &path, TextureManager *texMng)
+Model::Model(const std::string &path, TextureManager *texMng,
+             MeshCache *cache)
     : mTextureManager(texMng) {
-  loadModel(path);
+  mPath = path;
+  ModelData data;
+  if (Load(path, data, cache)) build(data);
   Logger::Success("Created model " + path);
 }
 
-void Model::loadModel(const std::string &path) {
+Model::Model(const std::string &path, ModelData data, TextureManager *texMng)
+    : mPath(path), mTextureManager(texMng) {
+  build(data);
+  Logger::Success("Created model " + path);
+}
+
+bool Model::Load(const std::string &path, ModelData &data, MeshCache *cache) {
+  if (cache && cache->Load(path, data)) {
+    Logger::Debug("Loaded model from cache: " + path);
+    return true;
+  }
+  if (!Parse(path, data)) return false;
+  if (cache) cache->Save(path, data);
+  return true;
+}
+
+bool Model::Parse(const std::string &path, ModelData &data) {
   Logger::Debug("Loading model: " + path);
-  mPath = path;
   Assimp::Importer importer;
   const aiScene *scene = importer.ReadFile(
       path, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenNormals);
@@ -18,31 +36,44 @@ void Model::loadModel(const std::string &path) {
   if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE ||
       !scene->mRootNode) {
     Logger::Error("ERROR::ASSIMP:: " + std::string(importer.GetErrorString()));
-    return;
+    return false;
   }
 
-  processNode(scene->mRootNode, scene);
-  calculateBoundingBox();
+  std::string directory = FileSystem::GetDirectoryFromPath(path);
+  processNode(scene->mRootNode, scene, directory, data);
+  calculateBoundingBox(data);
+  return true;
 }
 
-void Model::processNode(aiNode *node, const aiScene *scene) {
+void Model::build(ModelData &data) {
+  mMeshes.reserve(data.Meshes.size());
+  for (MeshData &mesh : data.Meshes) {
+    mMeshes.emplace_back(std::move(mesh.Vertices), std::move(mesh.Indices),
+                         mesh.Textures, mTextureManager);
+  }
+  mMinVert = data.MinVert;
+  mMaxVert = data.MaxVert;
+}
+
+void Model::processNode(aiNode *node, const aiScene *scene,
+                        const std::string &directory, ModelData &data) {
   for (unsigned int i = 0; i < node->mNumMeshes; i++) {
     aiMesh *mesh = scene->mMeshes[node->mMeshes[i]];
-    mMeshes.push_back(processMesh(mesh, scene));
+    data.Meshes.push_back(processMesh(mesh, scene, directory));
   }
 
   for (unsigned int i = 0; i < node->mNumChildren; i++) {
-    processNode(node->mChildren[i], scene);
+    processNode(node->mChildren[i], scene, directory, data);
   }
 }
 
-Mesh Model::processMesh(aiMesh *mesh, const aiScene *scene) {
-  std::vector<Vertex> vertices;
-  std::vector<GLuint> indices;
-  std::vector<std::string> textures;
+MeshData Model::processMesh(aiMesh *mesh, const aiScene *scene,
+                            const std::string &directory) {
+  MeshData data;
+  data.Vertices.resize(mesh->mNumVertices);
 
   for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
-    Vertex vertex;
+    Vertex &vertex = data.Vertices[i];
     vertex.Position = glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y,
                                 mesh->mVertices[i].z);
     vertex.Normal = glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y,
@@ -61,29 +92,28 @@ Mesh Model::processMesh(aiMesh *mesh, const aiScene *scene) {
     } else {
       vertex.Color = glm::vec3(1.0f, 1.0f, 1.0f);
     }
-
-    vertices.push_back(vertex);
   }
 
+  // Triangulated, every face has 3 indices
+  data.Indices.reserve(size_t(mesh->mNumFaces) * 3);
   for (unsigned int i = 0; i < mesh->mNumFaces; i++) {
-    aiFace face = mesh->mFaces[i];
-    indices.insert(indices.end(), face.mIndices,
-                   face.mIndices + face.mNumIndices);
+    const aiFace &face = mesh->mFaces[i];
+    data.Indices.insert(data.Indices.end(), face.mIndices,
+                        face.mIndices + face.mNumIndices);
   }
 
-  if (mesh->mMaterialIndex >= 0 && mTextureManager) {
+  if (mesh->mMaterialIndex < scene->mNumMaterials) {
     aiMaterial *material = scene->mMaterials[mesh->mMaterialIndex];
-    std::vector<std::string> diffuseMaps =
-        loadMaterialTextures(material, aiTextureType_DIFFUSE);
-    if (!diffuseMaps.empty()) textures = diffuseMaps;
+    data.Textures =
+        loadMaterialTextures(material, aiTextureType_DIFFUSE, directory);
   }
-  return Mesh(vertices, indices, textures, mTextureManager);
+  return data;
 }
 
-std::vector<std::string> Model::loadMaterialTextures(aiMaterial *mat,
-                                                     aiTextureType type) {
+std::vector<std::string>
+Model::loadMaterialTextures(aiMaterial *mat, aiTextureType type,
+                            const std::string &directory) {
   std::vector<std::string> textures;
-  std::string directory = FileSystem::GetDirectoryFromPath(mPath);
   for (unsigned int i = 0; i < mat->GetTextureCount(type); i++) {
     aiString str;
     mat->GetTexture(type, i, &str);
@@ -93,26 +123,17 @@ std::vector<std::string> Model::loadMaterialTextures(aiMaterial *mat,
   return textures;
 }
 
-void Model::calculateBoundingBox() {
-  if (mMeshes.empty()) return;
-
-  mMinVert = mMeshes[0].GetVertices()[0].Position;
-  mMaxVert = mMinVert;
-
-  for (const auto &mesh : mMeshes) {
-    for (const auto &vertex : mesh.GetVertices()) {
-      mMinVert = glm::min(mMinVert, vertex.Position);
-      mMaxVert = glm::max(mMaxVert, vertex.Position);
+void Model::calculateBoundingBox(ModelData &data) {
+  bool first = true;
+  for (const MeshData &mesh : data.Meshes) {
+    for (const Vertex &vertex : mesh.Vertices) {
+      if (first) {
+        data.MinVert = vertex.Position;
+        data.MaxVert = vertex.Position;
+        first = false;
+      }
+      data.MinVert = glm::min(data.MinVert, vertex.Position);
+      data.MaxVert = glm::max(data.MaxVert, vertex.Position);
     }
   }
 }
-
-void Model::Draw(Shader &shader, Camera &camera, const glm::vec3 &color) {
-  shader.Activate();
-  shader.SetMat4("uModel", mModel);
-
-  for (const Mesh &mesh : mMeshes) {
-    shader.SetVec3("uUniqueColor", color);
-    mesh.Draw(shader, camera, true);
-  }
-}
@@ -19,11 +19,16 @@ Quad::Quad() {
 }
 
 Quad::~Quad() {
+  SetTexture(nullptr);
   mVAO->Delete();
   mVBO->Delete();
 }
 
-void Quad::SetTexture(Texture *texture) { mTexture = texture; }
+void Quad::SetTexture(Texture *texture) {
+  if (texture) texture->Pin();
+  if (mTexture) mTexture->Unpin();
+  mTexture = texture;
+}
 
 void Quad::Draw() {
   mVAO->Bind();
@@ -0,0 +1,130 @@
+#include "Rendering/Models/SceneGeometry.h"
+
+#include <algorithm>
+
+#define BINDING_MODEL_MATRICES 1
+#define BINDING_DRAW_DATA 2
+
+SceneGeometry::SceneGeometry() {
+  glGenBuffers(1, &mIndirectID);
+  mModelMatrices = std::make_unique<SSBO>(BINDING_MODEL_MATRICES);
+  mDrawData = std::make_unique<SSBO>(BINDING_DRAW_DATA);
+}
+SceneGeometry::~SceneGeometry() {
+  release();
+  glDeleteBuffers(1, &mIndirectID);
+  mModelMatrices->Delete();
+  mDrawData->Delete();
+}
+
+void SceneGeometry::release() {
+  if (mVBO) mVBO->Delete();
+  if (mEBO) mEBO->Delete();
+  if (mVAO) mVAO->Delete();
+  mVBO.reset();
+  mEBO.reset();
+  mVAO.reset();
+  mBatches.clear();
+  mDrawCount = 0;
+}
+
+void SceneGeometry::Build(const std::vector<std::unique_ptr<Model>> &models) {
+  release();
+
+  struct PendingDraw {
+    Texture *Tex;
+    DrawCommand Command;
+    DrawData Data;
+  };
+  std::vector<Vertex> vertices;
+  std::vector<GLuint> indices;
+  std::vector<PendingDraw> draws;
+  for (size_t m = 0; m < models.size(); m++) {
+    for (Mesh &mesh : models[m]->GetMeshes()) {
+      PendingDraw draw;
+      draw.Tex = mesh.GetTexture();
+      draw.Command = {static_cast<GLuint>(mesh.GetIndices().size()), 1,
+                      static_cast<GLuint>(indices.size()),
+                      static_cast<GLint>(vertices.size()), 0};
+      draw.Data = {static_cast<GLuint>(m), static_cast<GLuint>(m + 1),
+                   draw.Tex != nullptr, 0};
+      draws.push_back(draw);
+      vertices.insert(vertices.end(), mesh.GetVertices().begin(),
+                      mesh.GetVertices().end());
+      indices.insert(indices.end(), mesh.GetIndices().begin(),
+                     mesh.GetIndices().end());
+    }
+  }
+  mMatrices.assign(models.size(), glm::mat4(1.0f));
+  if (draws.empty()) return;
+
+  // Group by texture so every batch needs one bind
+  std::stable_sort(draws.begin(), draws.end(),
+                   [](const PendingDraw &a, const PendingDraw &b) {
+                     return std::less<Texture *>()(a.Tex, b.Tex);
+                   });
+  std::vector<DrawCommand> commands;
+  std::vector<DrawData> drawData;
+  for (size_t i = 0; i < draws.size(); i++) {
+    DrawCommand command = draws[i].Command;
+    command.BaseInstance = static_cast<GLuint>(i);
+    commands.push_back(command);
+    drawData.push_back(draws[i].Data);
+
+    if (mBatches.empty() || mBatches.back().Tex != draws[i].Tex) {
+      mBatches.push_back({draws[i].Tex, static_cast<GLsizei>(i), 0});
+    }
+    mBatches.back().Count++;
+  }
+  mDrawCount = static_cast<int>(commands.size());
+
+  mVAO = std::make_unique<VAO>();
+  mVAO->Bind();
+  mVBO = std::make_unique<VBO<Vertex>>(vertices);
+  mEBO = std::make_unique<EBO>(indices);
+  mVAO->LinkAttrib(*mVBO, 0, 3, GL_FLOAT, sizeof(Vertex), (void *)0);
+  mVAO->LinkAttrib(*mVBO, 1, 3, GL_FLOAT, sizeof(Vertex),
+                   (void *)(3 * sizeof(float)));
+  mVAO->LinkAttrib(*mVBO, 2, 3, GL_FLOAT, sizeof(Vertex),
+                   (void *)(6 * sizeof(float)));
+  mVAO->LinkAttrib(*mVBO, 3, 2, GL_FLOAT, sizeof(Vertex),
+                   (void *)(9 * sizeof(float)));
+  mVAO->Unbind();
+
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, mIndirectID);
+  glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(DrawCommand),
+               commands.data(), GL_STATIC_DRAW);
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+  mDrawData->Update(drawData.data(), drawData.size() * sizeof(DrawData));
+
+  Logger::Debug("SceneGeometry: " + std::to_string(mDrawCount) +
+                " meshes in " + std::to_string(mBatches.size()) + " batches");
+}
+
+void SceneGeometry::UpdateTransforms(
+    const std::vector<std::unique_ptr<Model>> &models) {
+  if (mMatrices.size() != models.size()) return;
+  for (size_t i = 0; i < models.size(); i++) {
+    mMatrices[i] = models[i]->GetModelMatrix();
+  }
+  mModelMatrices->Update(mMatrices.data(),
+                         mMatrices.size() * sizeof(glm::mat4));
+}
+
+void SceneGeometry::Draw() const {
+  if (mBatches.empty()) return;
+
+  mVAO->Bind();
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, mIndirectID);
+  mModelMatrices->BindBase();
+  mDrawData->BindBase();
+  for (const DrawBatch &batch : mBatches) {
+    if (batch.Tex) batch.Tex->Bind();
+    glMultiDrawElementsIndirect(
+        GL_TRIANGLES, GL_UNSIGNED_INT,
+        (void *)(static_cast<size_t>(batch.First) * sizeof(DrawCommand)),
+        batch.Count, 0);
+  }
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+  mVAO->Unbind();
+}
@@ -1,85 +1,155 @@
 #include "Rendering/Shaders/Renderer.h"
 
+#include "Utilities/Profiler.h"
+
 Renderer::Renderer(const std::string &shadersPath) {
   mRgbShader =
       std::make_unique<Shader>(shadersPath, "colorVert.glsl", "colorFrag.glsl");
-  mFlatShader =
-      std::make_unique<Shader>(shadersPath, "flatVert.glsl", "flatFrag.glsl");
   mQuadShader =
       std::make_unique<Shader>(shadersPath, "quadVert.glsl", "quadFrag.glsl");
+  mSegmentationShader = std::make_unique<Shader>(
+      shadersPath, "quadVert.glsl", "segmentationFrag.glsl");
+  mPostShader =
+      std::make_unique<Shader>(shadersPath, "quadVert.glsl", "postFrag.glsl");
+  mCameraUBO = std::make_unique<UBO>(sizeof(CameraUniforms), 0);
+  mRandomizationUBO = std::make_unique<UBO>(sizeof(RandomizationUniforms), 1);
+  mScene = std::make_unique<SceneGeometry>();
   mPostProcessFBO = std::make_unique<FBO>(100, 100);
+  mSegmentationPreviewFBO = std::make_unique<FBO>(100, 100);
+
+  // Samplers never change units, set them once
+  mRgbShader->Activate();
+  mRgbShader->SetInt("uTex1", 0);
 
   glDisable(GL_DITHER);
   glDisable(GL_BLEND);
   glDisable(GL_MULTISAMPLE);
 }
 
-void Renderer::Begin(Camera *cam, FBO *fbo, ViewMode *viewMode, Quad *bgQuad) {
+void Renderer::UpdateScene(const std::vector<std::unique_ptr<Model>> &models,
+                           int revision) {
+  if (revision != mSceneRevision) {
+    mScene->Build(models);
+    mSceneRevision = revision;
+  }
+  mScene->UpdateTransforms(models);
+}
+
+void Renderer::SetRandomization(const RandomizationUniforms &randomization) {
+  mRandomizationUBO->Update(&randomization, sizeof(randomization));
+  mRandomizationUBO->BindBase();
+}
+
+void Renderer::Begin(Camera *cam, FBO *fbo, Quad *bgQuad) {
   if (!cam || !fbo) return;
+  OMVEX_PROFILE_GPU("Renderer::Begin");
 
   glEnable(GL_DEPTH_TEST);
   glm::mat4 mat = glm::mat4(1.0f);
   mat[2][2] = -1.0f;
   mRgbShader->Activate();
   mRgbShader->SetMat4("uMatrix", mat);
-  mFlatShader->Activate();
-  mFlatShader->SetMat4("uMatrix", mat);
+
+  // Per view camera data, shared by every mesh drawn in this pass
+  CameraUniforms camera;
+  camera.CamMatrix = cam->GetMatrix();
+  camera.CamPos = glm::vec4(cam->GetPosition(), 1.0f);
+  mCameraUBO->Update(&camera, sizeof(camera));
+  mCameraUBO->BindBase();
 
   fbo->Bind();
   glViewport(0, 0, cam->GetResolution().x, cam->GetResolution().y);
 
-  glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+  fbo->DrawToAll();
+  const GLfloat black[] = {0.0f, 0.0f, 0.0f, 1.0f};
+  const GLuint background[] = {0, 0, 0, 0};
+  glClearBufferfv(GL_COLOR, TargetColor, black);
+  glClearBufferuiv(GL_COLOR, TargetSegmentation, background);
+  glClear(GL_DEPTH_BUFFER_BIT);
 
-  if (*viewMode == ViewMode::Color && bgQuad->GetTexture()) {
+  // Background only goes to the color target
+  if (bgQuad->GetTexture()) {
+    fbo->DrawTo(TargetColor);
     glDisable(GL_DEPTH_TEST);
     mQuadShader->Activate();
     bgQuad->GetTexture()->Bind();
     mQuadShader->SetFloat("uDim", 0.0f);
     bgQuad->Draw();
     glEnable(GL_DEPTH_TEST);
+    fbo->DrawToAll();
   }
 }
-void Renderer::RenderModel(Camera *cam, FBO *fbo, ViewMode *viewMode,
-                           Model *model, glm::vec3 &color) {
+void Renderer::RenderScene(Camera *cam, FBO *fbo) {
   if (!cam || !fbo) return;
+  OMVEX_PROFILE_GPU("Renderer::RenderScene");
 
-  if (*viewMode == ViewMode::Color) {
-    mRgbShader->Activate();
-    model->Draw(*mRgbShader, *cam, {});
-  } else if (*viewMode == ViewMode::Segmentation) {
-    mFlatShader->Activate();
-    model->Draw(*mFlatShader, *cam, color);
-  }
+  mRgbShader->Activate();
+  mScene->Draw();
 }
-void Renderer::End(Quad *dimQuad, float dim, ViewMode *viewMode, FBO *fbo) {
-  if (!dimQuad || !fbo || !viewMode || !fbo->ColorTexture) return;
+void Renderer::End(Quad *postQuad, FBO *fbo) {
+  if (!postQuad || !fbo || !fbo->GetColorTexture(TargetColor)) return;
+  OMVEX_PROFILE_GPU("Renderer::End");
 
-  if (*viewMode == ViewMode::Color) {
-    glm::vec2 size = fbo->ColorTexture->GetSize();
+  Texture *colorTexture = fbo->GetColorTexture(TargetColor);
+  glm::vec2 size = colorTexture->GetSize();
 
-    if (mPostProcessFBO->ColorTexture->GetSize() != size) {
-      mPostProcessFBO->Resize(size.x, size.y);
-    }
+  if (mPostProcessFBO->GetColorTexture()->GetSize() != size) {
+    mPostProcessFBO->Resize(size.x, size.y);
+  }
 
-    mPostProcessFBO->Bind();
-    glDisable(GL_DEPTH_TEST);
-    mQuadShader->Activate();
-    fbo->ColorTexture->Bind();
-    mQuadShader->SetFloat("uDim", dim);
-    dimQuad->Draw();
-    fbo->ColorTexture->Unbind();
-    mPostProcessFBO->Unbind();
-    glEnable(GL_DEPTH_TEST);
+  mPostProcessFBO->Bind();
+  glDisable(GL_DEPTH_TEST);
+  mPostShader->Activate();
+  colorTexture->Bind();
+  postQuad->Draw();
+  colorTexture->Unbind();
+  mPostProcessFBO->Unbind();
+  glEnable(GL_DEPTH_TEST);
 
-    mPostProcessFBO->BindRead();
-    fbo->BindDraw();
+  // Blit writes every enabled draw buffer, restrict it to the color target
+  mPostProcessFBO->BindRead();
+  fbo->BindDraw();
+  fbo->DrawTo(TargetColor);
 
-    glBlitFramebuffer(0, 0, size.x, size.y, 0, 0, size.x, size.y,
-                      GL_COLOR_BUFFER_BIT, GL_NEAREST);
+  glBlitFramebuffer(0, 0, size.x, size.y, 0, 0, size.x, size.y,
+                    GL_COLOR_BUFFER_BIT, GL_NEAREST);
 
-    fbo->Unbind();
-    mPostProcessFBO->Unbind();
-  }
+  fbo->DrawToAll();
   fbo->Unbind();
+  mPostProcessFBO->Unbind();
+}
+
+void Renderer::RenderViews(const std::vector<RenderView> &views, Quad *bgQuad,
+                           Quad *postQuad) {
+  OMVEX_PROFILE_SCOPE("Renderer::RenderViews");
+  for (const RenderView &view : views) {
+    bgQuad->SetTexture(view.Background);
+    SetRandomization(view.Randomization);
+    Begin(view.Cam, view.Target, bgQuad);
+    RenderScene(view.Cam, view.Target);
+    End(postQuad, view.Target);
+  }
+  bgQuad->SetTexture(nullptr);
+}
+
+void Renderer::RenderSegmentationPreview(FBO *fbo, Quad *quad,
+                                         int numInstances) {
+  Texture *ids = fbo ? fbo->GetColorTexture(TargetSegmentation) : nullptr;
+  if (!ids || !quad) return;
+
+  glm::vec2 size = ids->GetSize();
+  if (mSegmentationPreviewFBO->GetColorTexture()->GetSize() != size) {
+    mSegmentationPreviewFBO->Resize(size.x, size.y);
+  }
+
+  mSegmentationPreviewFBO->Bind();
+  glViewport(0, 0, size.x, size.y);
+  glDisable(GL_DEPTH_TEST);
+  mSegmentationShader->Activate();
+  ids->Bind();
+  mSegmentationShader->SetUInt("uInstanceCount", numInstances);
+  quad->Draw();
+  ids->Unbind();
+  glEnable(GL_DEPTH_TEST);
+  mSegmentationPreviewFBO->Unbind();
 }
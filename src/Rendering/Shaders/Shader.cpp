@@ -37,6 +37,7 @@ Shader::Shader(const char *vertexShaderPath, const char *fragmentShaderPath) {
   }
 
   if (successLink) {
+    cacheUniformLocations();
     Logger::Success("Shader compiled: " + std::string(vertexShaderPath) + ", " +
                     std::string(fragmentShaderPath));
   } else {
@@ -86,26 +87,55 @@ void Shader::Activate() { glUseProgram(mID); }
 void Shader::Delete() { glDeleteProgram(mID); }
 
 void Shader::SetBool(const std::string &name, bool value) const {
-  glUniform1i(getLocation(name.c_str()), (int)value);
+  glUniform1i(getLocation(name), (int)value);
 }
 void Shader::SetInt(const std::string &name, int value) const {
-  glUniform1i(getLocation(name.c_str()), value);
+  glUniform1i(getLocation(name), value);
+}
+void Shader::SetUInt(const std::string &name, unsigned int value) const {
+  glUniform1ui(getLocation(name), value);
 }
 void Shader::SetFloat(const std::string &name, const float value) const {
-  glUniform1f(getLocation(name.c_str()), value);
+  glUniform1f(getLocation(name), value);
 }
 void Shader::SetVec3(const std::string &name, const glm::vec3 &value) const {
-  glUniform3f(getLocation(name.c_str()), value.x, value.y, value.z);
+  glUniform3f(getLocation(name), value.x, value.y, value.z);
 }
 void Shader::SetVec4(const std::string &name, const glm::vec4 &value) const {
-  glUniform4f(getLocation(name.c_str()), value.x, value.y, value.z, value.w);
+  glUniform4f(getLocation(name), value.x, value.y, value.z, value.w);
 }
 void Shader::SetMat4(const std::string &name, const glm::mat4 &value) const {
-  glUniformMatrix4fv(getLocation(name.c_str()), 1, GL_FALSE,
+  glUniformMatrix4fv(getLocation(name), 1, GL_FALSE,
                      glm::value_ptr(value));
 }
 
 int Shader::getLocation(const std::string &name) const {
-  int location = glGetUniformLocation(mID, name.c_str());
-  return location;
+  auto it = mLocations.find(name);
+  return it != mLocations.end() ? it->second : -1;
+}
+
+void Shader::cacheUniformLocations() {
+  GLint count = 0;
+  GLint maxLength = 0;
+  glGetProgramiv(mID, GL_ACTIVE_UNIFORMS, &count);
+  glGetProgramiv(mID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+  if (count <= 0 || maxLength <= 0) return;
+
+  std::string name(maxLength, '\0');
+  for (GLint i = 0; i < count; i++) {
+    GLsizei length = 0;
+    GLint size = 0;
+    GLenum type = 0;
+    glGetActiveUniform(mID, i, maxLength, &length, &size, &type, &name[0]);
+    std::string uniform = name.substr(0, length);
+    // Uniform block members have no location
+    int location = glGetUniformLocation(mID, uniform.c_str());
+    if (location < 0) continue;
+    // Arrays are reported as name[0], also allow plain name
+    size_t bracket = uniform.rfind("[0]");
+    if (bracket != std::string::npos && bracket == uniform.size() - 3) {
+      mLocations[uniform.substr(0, bracket)] = location;
+    }
+    mLocations[uniform] = location;
+  }
 }
@@ -0,0 +1,238 @@
+#include "Rendering/Textures/BlockCompression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+// Fetches a 4x4 block as RGBA, repeating edge pixels
+void loadBlock(const PixelBuffer &pixels, int bx, int by,
+               unsigned char block[16][4]) {
+  const unsigned char *data = pixels.GetData();
+  int channels = pixels.GetChannels();
+  for (int y = 0; y < 4; y++) {
+    int sy = std::min(by * 4 + y, pixels.GetHeight() - 1);
+    for (int x = 0; x < 4; x++) {
+      int sx = std::min(bx * 4 + x, pixels.GetWidth() - 1);
+      const unsigned char *texel =
+          data + (size_t(sy) * pixels.GetWidth() + sx) * channels;
+      unsigned char *out = block[y * 4 + x];
+      for (int c = 0; c < 3; c++) out[c] = texel[channels >= 3 ? c : 0];
+      out[3] = channels == 4 ? texel[3] : 255;
+    }
+  }
+}
+
+// Corners of the bounding box, the diagonal is flipped per channel so it
+// follows the sign of the covariance with the widest channel
+void boundingEndpoints(const unsigned char block[16][4], int numChannels,
+                       int low[4], int high[4]) {
+  int mean[4] = {0, 0, 0, 0};
+  for (int c = 0; c < numChannels; c++) {
+    low[c] = 255;
+    high[c] = 0;
+    for (int i = 0; i < 16; i++) {
+      low[c] = std::min(low[c], int(block[i][c]));
+      high[c] = std::max(high[c], int(block[i][c]));
+      mean[c] += block[i][c];
+    }
+    mean[c] /= 16;
+  }
+  int axis = 0;
+  for (int c = 1; c < numChannels; c++) {
+    if (high[c] - low[c] > high[axis] - low[axis]) axis = c;
+  }
+  for (int c = 0; c < numChannels; c++) {
+    if (c == axis) continue;
+    int covariance = 0;
+    for (int i = 0; i < 16; i++) {
+      covariance += (block[i][axis] - mean[axis]) * (block[i][c] - mean[c]);
+    }
+    if (covariance < 0) std::swap(low[c], high[c]);
+  }
+}
+
+uint16_t packRGB565(const int color[4]) {
+  return uint16_t(((color[0] * 31 + 127) / 255) << 11 |
+                  ((color[1] * 63 + 127) / 255) << 5 |
+                  ((color[2] * 31 + 127) / 255));
+}
+
+void unpackRGB565(uint16_t packed, int color[3]) {
+  int r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+  color[0] = (r << 3) | (r >> 2);
+  color[1] = (g << 2) | (g >> 4);
+  color[2] = (b << 3) | (b >> 2);
+}
+
+void encodeBC1Block(const unsigned char block[16][4], unsigned char *out) {
+  int low[4], high[4];
+  boundingEndpoints(block, 3, low, high);
+  uint16_t color0 = packRGB565(high);
+  uint16_t color1 = packRGB565(low);
+  // color0 > color1 selects the four color mode
+  if (color0 < color1) std::swap(color0, color1);
+
+  uint32_t indices = 0;
+  if (color0 != color1) {
+    int palette[4][3];
+    unpackRGB565(color0, palette[0]);
+    unpackRGB565(color1, palette[1]);
+    for (int c = 0; c < 3; c++) {
+      palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+      palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+    for (int i = 0; i < 16; i++) {
+      int best = 0, bestError = INT32_MAX;
+      for (int p = 0; p < 4; p++) {
+        int error = 0;
+        for (int c = 0; c < 3; c++) {
+          int d = block[i][c] - palette[p][c];
+          error += d * d;
+        }
+        if (error < bestError) {
+          bestError = error;
+          best = p;
+        }
+      }
+      indices |= uint32_t(best) << (i * 2);
+    }
+  }
+  std::memcpy(out, &color0, 2);
+  std::memcpy(out + 2, &color1, 2);
+  std::memcpy(out + 4, &indices, 4);
+}
+
+// Little endian bit stream over one 128 bit block
+struct BitWriter {
+  unsigned char *Out;
+  int Bit = 0;
+  void Write(uint32_t value, int bits) {
+    for (int i = 0; i < bits; i++, Bit++) {
+      if ((value >> i) & 1) Out[Bit / 8] |= uint8_t(1 << (Bit % 8));
+    }
+  }
+};
+
+// Endpoint channels are 7 bits plus a parity bit shared by the endpoint.
+// Opaque endpoints keep parity 1 so alpha decodes to exactly 255.
+void quantizeBC7Endpoint(const int color[4], int quantized[4], int &parity) {
+  int bestError = INT32_MAX;
+  for (int p = color[3] == 255 ? 1 : 0; p < 2; p++) {
+    int error = 0;
+    int candidate[4];
+    for (int c = 0; c < 4; c++) {
+      candidate[c] = std::clamp((color[c] - p + 1) / 2, 0, 127);
+      int d = ((candidate[c] << 1) | p) - color[c];
+      error += d * d;
+    }
+    if (error < bestError) {
+      bestError = error;
+      parity = p;
+      std::copy(candidate, candidate + 4, quantized);
+    }
+  }
+}
+
+void encodeBC7Block(const unsigned char block[16][4], unsigned char *out) {
+  static const int weights[16] = {0,  4,  9,  13, 17, 21, 26, 30,
+                                  34, 38, 43, 47, 51, 55, 60, 64};
+  int low[4], high[4];
+  boundingEndpoints(block, 4, low, high);
+  int quantized[2][4], parity[2];
+  quantizeBC7Endpoint(low, quantized[0], parity[0]);
+  quantizeBC7Endpoint(high, quantized[1], parity[1]);
+
+  int endpoints[2][4];
+  int direction[4];
+  int length = 0;
+  for (int c = 0; c < 4; c++) {
+    endpoints[0][c] = (quantized[0][c] << 1) | parity[0];
+    endpoints[1][c] = (quantized[1][c] << 1) | parity[1];
+    direction[c] = endpoints[1][c] - endpoints[0][c];
+    length += direction[c] * direction[c];
+  }
+
+  int indices[16] = {0};
+  for (int i = 0; length > 0 && i < 16; i++) {
+    int projection = 0;
+    for (int c = 0; c < 4; c++) {
+      projection += (block[i][c] - endpoints[0][c]) * direction[c];
+    }
+    float t = 64.0f * projection / length;
+    int best = 0;
+    for (int w = 1; w < 16; w++) {
+      if (std::abs(weights[w] - t) < std::abs(weights[best] - t)) best = w;
+    }
+    indices[i] = best;
+  }
+  // The anchor index drops its top bit, swap ends so it is clear
+  if (indices[0] & 8) {
+    std::swap(quantized[0], quantized[1]);
+    std::swap(parity[0], parity[1]);
+    for (int &index : indices) index = 15 - index;
+  }
+
+  std::memset(out, 0, 16);
+  BitWriter writer{out};
+  writer.Write(1u << 6, 7);
+  for (int c = 0; c < 4; c++) {
+    writer.Write(quantized[0][c], 7);
+    writer.Write(quantized[1][c], 7);
+  }
+  writer.Write(parity[0], 1);
+  writer.Write(parity[1], 1);
+  for (int i = 0; i < 16; i++) writer.Write(indices[i], i == 0 ? 3 : 4);
+}
+} // namespace
+
+namespace BlockCompression {
+
+GLenum GetFormat(TextureCompression mode) {
+  switch (mode) {
+  case TextureCompression::BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+  case TextureCompression::BC7: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+  default: return 0;
+  }
+}
+
+CompressedImage Encode(const PixelBuffer &pixels, TextureCompression mode) {
+  CompressedImage image;
+  if (mode == TextureCompression::None || pixels.GetBytesPerChannel() != 1 ||
+      pixels.GetSize() == 0) {
+    return image;
+  }
+  image.Format = GetFormat(mode);
+  image.Width = pixels.GetWidth();
+  image.Height = pixels.GetHeight();
+  int blocksX = (image.Width + 3) / 4;
+  int blocksY = (image.Height + 3) / 4;
+  size_t blockSize = mode == TextureCompression::BC1 ? 8 : 16;
+  image.Data.resize(size_t(blocksX) * blocksY * blockSize);
+
+  unsigned char block[16][4];
+  for (int by = 0; by < blocksY; by++) {
+    for (int bx = 0; bx < blocksX; bx++) {
+      loadBlock(pixels, bx, by, block);
+      unsigned char *out =
+          image.Data.data() + (size_t(by) * blocksX + bx) * blockSize;
+      if (mode == TextureCompression::BC1) {
+        encodeBC1Block(block, out);
+      } else {
+        encodeBC7Block(block, out);
+      }
+    }
+  }
+  return image;
+}
+
+bool Parse(const std::string &name, TextureCompression &mode) {
+  if (name == "none") mode = TextureCompression::None;
+  else if (name == "bc1") mode = TextureCompression::BC1;
+  else if (name == "bc7") mode = TextureCompression::BC7;
+  else return false;
+  return true;
+}
+
+} // namespace BlockCompression
@@ -0,0 +1,316 @@
+#include "Rendering/Textures/ImageEncoder.h"
+
+#include "Core/Logger.h"
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb_image_write.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+uint32_t crc32(const unsigned char *data, size_t size, uint32_t crc = 0) {
+  // Built once, function statics are initialized thread safe
+  static const std::array<uint32_t, 256> table = []() {
+    std::array<uint32_t, 256> t{};
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t c = i;
+      for (int k = 0; k < 8; k++)
+        c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+      t[i] = c;
+    }
+    return t;
+  }();
+  crc = ~crc;
+  for (size_t i = 0; i < size; i++)
+    crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+  return ~crc;
+}
+uint32_t adler32(const unsigned char *data, size_t size) {
+  uint32_t a = 1, b = 0;
+  while (size > 0) {
+    // Largest block before b can overflow
+    size_t block = std::min<size_t>(size, 5552);
+    size -= block;
+    for (size_t i = 0; i < block; i++) {
+      a += data[i];
+      b += a;
+    }
+    data += block;
+    a %= 65521;
+    b %= 65521;
+  }
+  return (b << 16) | a;
+}
+void pushBigEndian(std::vector<unsigned char> &out, uint32_t value) {
+  out.push_back(static_cast<unsigned char>(value >> 24));
+  out.push_back(static_cast<unsigned char>(value >> 16));
+  out.push_back(static_cast<unsigned char>(value >> 8));
+  out.push_back(static_cast<unsigned char>(value));
+}
+void pushChunk(std::vector<unsigned char> &png, const char *type,
+               const unsigned char *data, size_t size) {
+  pushBigEndian(png, static_cast<uint32_t>(size));
+  size_t typeStart = png.size();
+  png.insert(png.end(), type, type + 4);
+  if (size > 0) png.insert(png.end(), data, data + size);
+  pushBigEndian(png, crc32(png.data() + typeStart, size + 4));
+}
+
+// zlib stream of stored deflate blocks, no compression at all
+void storeZlib(const std::vector<unsigned char> &raw,
+               std::vector<unsigned char> &out) {
+  constexpr size_t MAX_BLOCK = 65535;
+  out.reserve(raw.size() + raw.size() / MAX_BLOCK * 5 + 11);
+  out.push_back(0x78);
+  out.push_back(0x01);
+  size_t offset = 0;
+  do {
+    size_t size = std::min(MAX_BLOCK, raw.size() - offset);
+    bool last = offset + size == raw.size();
+    out.push_back(last ? 1 : 0);
+    out.push_back(static_cast<unsigned char>(size));
+    out.push_back(static_cast<unsigned char>(size >> 8));
+    out.push_back(static_cast<unsigned char>(~size));
+    out.push_back(static_cast<unsigned char>(~size >> 8));
+    out.insert(out.end(), raw.begin() + offset, raw.begin() + offset + size);
+    offset += size;
+  } while (offset < raw.size());
+  pushBigEndian(out, adler32(raw.data(), raw.size()));
+}
+
+unsigned char paeth(int a, int b, int c) {
+  int p = a + b - c;
+  int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+  if (pa <= pb && pa <= pc) return static_cast<unsigned char>(a);
+  if (pb <= pc) return static_cast<unsigned char>(b);
+  return static_cast<unsigned char>(c);
+}
+// Writes filter type and the filtered row to out
+void filterRow(int type, const unsigned char *row, const unsigned char *prev,
+               size_t size, int bpp, unsigned char *out) {
+  out[0] = static_cast<unsigned char>(type);
+  for (size_t i = 0; i < size; i++) {
+    int a = i >= size_t(bpp) ? row[i - bpp] : 0;
+    int b = prev ? prev[i] : 0;
+    int c = prev && i >= size_t(bpp) ? prev[i - bpp] : 0;
+    int predicted = 0;
+    switch (type) {
+    case 1: predicted = a; break;
+    case 2: predicted = b; break;
+    case 3: predicted = (a + b) / 2; break;
+    case 4: predicted = paeth(a, b, c); break;
+    default: break;
+    }
+    out[i + 1] = static_cast<unsigned char>(row[i] - predicted);
+  }
+}
+uint64_t filterCost(const unsigned char *filtered, size_t size) {
+  uint64_t cost = 0;
+  for (size_t i = 0; i < size; i++)
+    cost += std::abs(static_cast<int>(static_cast<signed char>(filtered[i])));
+  return cost;
+}
+
+void appendBytes(void *context, void *data, int size) {
+  auto *out = static_cast<std::vector<unsigned char> *>(context);
+  const unsigned char *bytes = static_cast<const unsigned char *>(data);
+  out->insert(out->end(), bytes, bytes + size);
+}
+} // namespace
+
+std::unique_ptr<ImageEncoder> ImageEncoder::Create(const std::string &spec) {
+  size_t colon = spec.find(':');
+  std::string name = spec.substr(0, colon);
+  bool hasValue = colon != std::string::npos;
+  int value = hasValue ? std::atoi(spec.c_str() + colon + 1) : 0;
+  if (name == "png") {
+    return std::make_unique<PngEncoder>(hasValue ? value : 8);
+  }
+  if (name == "jpeg" || name == "jpg") {
+    return std::make_unique<JpegEncoder>(hasValue ? value : 90);
+  }
+  if (name == "qoi") return std::make_unique<QoiEncoder>();
+  return nullptr;
+}
+
+PngEncoder::PngEncoder(int level) : mLevel(std::clamp(level, 0, 9)) {}
+
+bool PngEncoder::Supports(int channels, int bytesPerChannel) const {
+  return channels >= 1 && channels <= 4 &&
+         (bytesPerChannel == 1 || bytesPerChannel == 2);
+}
+
+bool PngEncoder::Encode(const PixelBuffer &pixels,
+                        std::vector<unsigned char> &out) const {
+  int channels = pixels.GetChannels();
+  int depth = pixels.GetBytesPerChannel();
+  if (!Supports(channels, depth)) return false;
+  int width = pixels.GetWidth();
+  int height = pixels.GetHeight();
+  size_t rowSize = size_t(pixels.GetStride());
+  int bpp = channels * depth;
+
+  // Each row is its filter type byte and the filtered samples, PNG samples
+  // are big endian
+  std::vector<unsigned char> raw(size_t(height) * (rowSize + 1));
+  std::vector<unsigned char> row(rowSize), prev(rowSize);
+  std::vector<unsigned char> candidate(rowSize + 1);
+  for (int y = 0; y < height; y++) {
+    const unsigned char *src = pixels.GetData() + size_t(y) * rowSize;
+    if (depth == 2) {
+      for (size_t i = 0; i < rowSize; i += 2) {
+        row[i] = src[i + 1];
+        row[i + 1] = src[i];
+      }
+    } else {
+      std::memcpy(row.data(), src, rowSize);
+    }
+    const unsigned char *above = y > 0 ? prev.data() : nullptr;
+    unsigned char *dst = raw.data() + size_t(y) * (rowSize + 1);
+    if (mLevel == 0) {
+      filterRow(0, row.data(), above, rowSize, bpp, dst);
+    } else if (mLevel < 5) {
+      filterRow(2, row.data(), above, rowSize, bpp, dst);
+    } else {
+      // Smallest sum of absolute differences usually compresses best
+      uint64_t bestCost = UINT64_MAX;
+      for (int type = 0; type < 5; type++) {
+        filterRow(type, row.data(), above, rowSize, bpp, candidate.data());
+        uint64_t cost = filterCost(candidate.data() + 1, rowSize);
+        if (cost < bestCost) {
+          bestCost = cost;
+          std::memcpy(dst, candidate.data(), rowSize + 1);
+        }
+      }
+    }
+    std::swap(row, prev);
+  }
+
+  std::vector<unsigned char> compressed;
+  if (mLevel == 0) {
+    storeZlib(raw, compressed);
+  } else {
+    // stb clamps the match search depth to at least 5
+    int compressedSize = 0;
+    unsigned char *data = stbi_zlib_compress(
+        raw.data(), static_cast<int>(raw.size()), &compressedSize, mLevel);
+    if (!data) return false;
+    compressed.assign(data, data + compressedSize);
+    STBIW_FREE(data);
+  }
+
+  static const unsigned char colorTypes[] = {0, 0, 4, 2, 6};
+  std::vector<unsigned char> header;
+  pushBigEndian(header, width);
+  pushBigEndian(header, height);
+  header.insert(header.end(), {static_cast<unsigned char>(depth * 8),
+                               colorTypes[channels], 0, 0, 0});
+
+  const unsigned char signature[] = {0x89, 'P',  'N',  'G',
+                                     '\r', '\n', 0x1A, '\n'};
+  out.assign(signature, signature + 8);
+  out.reserve(compressed.size() + 64);
+  pushChunk(out, "IHDR", header.data(), header.size());
+  pushChunk(out, "IDAT", compressed.data(), compressed.size());
+  pushChunk(out, "IEND", nullptr, 0);
+  return true;
+}
+
+JpegEncoder::JpegEncoder(int quality) : mQuality(std::clamp(quality, 1, 100)) {}
+
+bool JpegEncoder::Supports(int channels, int bytesPerChannel) const {
+  return channels >= 1 && channels <= 4 && bytesPerChannel == 1;
+}
+
+bool JpegEncoder::Encode(const PixelBuffer &pixels,
+                         std::vector<unsigned char> &out) const {
+  if (!Supports(pixels.GetChannels(), pixels.GetBytesPerChannel())) {
+    return false;
+  }
+  out.clear();
+  return stbi_write_jpg_to_func(appendBytes, &out, pixels.GetWidth(),
+                                pixels.GetHeight(), pixels.GetChannels(),
+                                pixels.GetData(), mQuality) != 0;
+}
+
+bool QoiEncoder::Supports(int channels, int bytesPerChannel) const {
+  return (channels == 3 || channels == 4) && bytesPerChannel == 1;
+}
+
+bool QoiEncoder::Encode(const PixelBuffer &pixels,
+                        std::vector<unsigned char> &out) const {
+  int channels = pixels.GetChannels();
+  if (!Supports(channels, pixels.GetBytesPerChannel())) return false;
+  size_t count = size_t(pixels.GetWidth()) * pixels.GetHeight();
+
+  out.clear();
+  // Worst case is one tag byte more than the pixel per pixel
+  out.reserve(14 + count * (channels + 1) + 8);
+  out.insert(out.end(), {'q', 'o', 'i', 'f'});
+  pushBigEndian(out, pixels.GetWidth());
+  pushBigEndian(out, pixels.GetHeight());
+  out.push_back(static_cast<unsigned char>(channels));
+  out.push_back(0); // sRGB with linear alpha
+
+  struct Rgba {
+    unsigned char R = 0, G = 0, B = 0, A = 255;
+    bool operator==(const Rgba &o) const {
+      return R == o.R && G == o.G && B == o.B && A == o.A;
+    }
+  };
+  Rgba index[64] = {};
+  for (Rgba &entry : index)
+    entry.A = 0;
+  Rgba previous;
+  int run = 0;
+  const unsigned char *data = pixels.GetData();
+  for (size_t i = 0; i < count; i++) {
+    const unsigned char *p = data + i * channels;
+    Rgba pixel{p[0], p[1], p[2], channels == 4 ? p[3] : (unsigned char)255};
+    if (pixel == previous) {
+      run++;
+      if (run == 62 || i + 1 == count) {
+        out.push_back(static_cast<unsigned char>(0xC0 | (run - 1)));
+        run = 0;
+      }
+      continue;
+    }
+    if (run > 0) {
+      out.push_back(static_cast<unsigned char>(0xC0 | (run - 1)));
+      run = 0;
+    }
+    int hash = (pixel.R * 3 + pixel.G * 5 + pixel.B * 7 + pixel.A * 11) % 64;
+    if (index[hash] == pixel) {
+      out.push_back(static_cast<unsigned char>(hash));
+    } else {
+      index[hash] = pixel;
+      if (pixel.A == previous.A) {
+        signed char dr = static_cast<signed char>(pixel.R - previous.R);
+        signed char dg = static_cast<signed char>(pixel.G - previous.G);
+        signed char db = static_cast<signed char>(pixel.B - previous.B);
+        int drg = dr - dg;
+        int dbg = db - dg;
+        if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 &&
+            db <= 1) {
+          out.push_back(static_cast<unsigned char>(
+              0x40 | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2)));
+        } else if (drg >= -8 && drg <= 7 && dg >= -32 && dg <= 31 &&
+                   dbg >= -8 && dbg <= 7) {
+          out.push_back(static_cast<unsigned char>(0x80 | (dg + 32)));
+          out.push_back(static_cast<unsigned char>((drg + 8) << 4 | (dbg + 8)));
+        } else {
+          out.insert(out.end(), {0xFE, pixel.R, pixel.G, pixel.B});
+        }
+      } else {
+        out.insert(out.end(), {0xFF, pixel.R, pixel.G, pixel.B, pixel.A});
+      }
+    }
+    previous = pixel;
+  }
+  out.insert(out.end(), {0, 0, 0, 0, 0, 0, 0, 1});
+  return true;
+}
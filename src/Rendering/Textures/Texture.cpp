@@ -1,12 +1,14 @@
 #include "Rendering/Textures/Texture.h"
 
 #include "Core/Logger.h"
+#include "Rendering/Textures/ImageEncoder.h"
+#include "Utilities/Profiler.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
-#define STB_IMAGE_WRITE_IMPLEMENTATION
-#include "stb_image_write.h"
+#include <cstdint>
+#include <fstream>
 
 void Texture::initializeCommonMembers(int width, int height, int channels) {
   mWidth = width;
@@ -56,38 +58,32 @@ GLenum getInternalFormatFromChannels(int channels) {
 
 Texture::Texture(const std::string &filePath) : mFilePath(filePath) {
   loadTexture(filePath);
-  mSize = glm::vec2(static_cast<float>(mWidth), static_cast<float>(mHeight));
-  mAspectRatio = mSize.x / mSize.y;
+}
+
+Texture::Texture(const std::string &filePath, const PixelBuffer &pixels)
+    : mFilePath(filePath) {
+  uploadPixels(pixels);
 }
 
 Texture::Texture(int width, int height, int channels) {
   initializeCommonMembers(width, height, channels);
+  mFormat.InternalFormat = getInternalFormatFromChannels(channels);
+  mFormat.Format = getFormatFromChannels(channels);
+  mFormat.Channels = channels;
   createTextureObject();
-  setupTextureData(nullptr, getInternalFormatFromChannels(channels),
-                   getFormatFromChannels(channels), GL_UNSIGNED_BYTE);
+  setupTextureData(nullptr, mFormat.InternalFormat, mFormat.Format,
+                   mFormat.Type);
   setTextureParameters(GL_LINEAR);
   Unbind();
 }
-inline unsigned char FloatToByte(float value) {
-  return static_cast<unsigned char>(
-      round(glm::clamp(value, 0.0f, 1.0f) * 255.0f));
-}
-Texture::Texture(const std::vector<glm::vec3> &pixelColors) {
-  int width = static_cast<int>(pixelColors.size());
-  initializeCommonMembers(width, 1, 4);
 
-  std::vector<unsigned char> imageData(mWidth * 4); // RGBA per pixel
-
-  for (int i = 0; i < mWidth; ++i) {
-    glm::vec4 color = glm::vec4(pixelColors[i], 1.0f);
-    imageData[i * 4 + 0] = FloatToByte(color.r);
-    imageData[i * 4 + 1] = FloatToByte(color.g);
-    imageData[i * 4 + 2] = FloatToByte(color.b);
-    imageData[i * 4 + 3] = FloatToByte(color.a);
-  }
+Texture::Texture(int width, int height, const TextureFormat &format)
+    : mFormat(format) {
+  initializeCommonMembers(width, height, format.Channels);
   createTextureObject();
-  setupTextureData(imageData.data(), GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
-  setTextureParameters(GL_NEAREST);
+  setupTextureData(nullptr, format.InternalFormat, format.Format, format.Type);
+  // Integer textures are incomplete with linear filtering
+  setTextureParameters(format.IsInteger() ? GL_NEAREST : GL_LINEAR);
   Unbind();
 }
 
@@ -101,39 +97,88 @@ void Texture::Bind() const {
 void Texture::Unbind() const { glBindTexture(GL_TEXTURE_2D, 0); }
 
 void Texture::loadTexture(const std::string &filePath) {
-  stbi_set_flip_vertically_on_load(false);
+  PixelBuffer pixels;
+  Decode(filePath, pixels);
+  uploadPixels(pixels);
+}
 
-  // Load image data
+bool Texture::Decode(const std::string &filePath, PixelBuffer &pixels) {
+  int width = 0, height = 0, channels = 0;
   unsigned char *data =
-      stbi_load(filePath.c_str(), &mWidth, &mHeight, &mChannels, 0);
+      stbi_load(filePath.c_str(), &width, &height, &channels, 0);
   if (!data) {
     Logger::Error("Failed to load texture: " + filePath);
+    return false;
   }
+  size_t size = size_t(width) * height * channels;
+  std::vector<unsigned char> owned(data, data + size);
+  stbi_image_free(data);
+  pixels = PixelBuffer(width, height, channels, 1, std::move(owned));
+  return true;
+}
 
+void Texture::uploadPixels(const PixelBuffer &pixels) {
   createTextureObject();
   setTextureParameters(GL_LINEAR);
-  setupTextureData(data, getInternalFormatFromChannels(mChannels),
-                   getFormatFromChannels(mChannels), GL_UNSIGNED_BYTE);
+  const unsigned char *data = pixels.GetSize() > 0 ? pixels.GetData() : nullptr;
+  SetPixels(pixels.GetWidth(), pixels.GetHeight(), pixels.GetChannels(), data);
+}
 
-  stbi_image_free(data);
+void Texture::SetPixels(int width, int height, int channels,
+                        const void *data) {
+  initializeCommonMembers(width, height, channels);
+  mFormat.InternalFormat = getInternalFormatFromChannels(mChannels);
+  mFormat.Format = getFormatFromChannels(mChannels);
+  mFormat.Channels = mChannels;
+  Bind();
+  // Rows of 3 channel images are not 4 byte aligned
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexImage2D(GL_TEXTURE_2D, 0, mFormat.InternalFormat, mWidth, mHeight, 0,
+               mFormat.Format, mFormat.Type, data);
+  if (mWidth > 0 && mHeight > 0) glGenerateMipmap(GL_TEXTURE_2D);
+  mBytes = size_t(mWidth) * mHeight * mChannels * 4 / 3;
+  Unbind();
+}
+
+void Texture::SetCompressedPixels(GLenum format, int width, int height,
+                                  GLsizei size, const void *data) {
+  // Reads back decompressed as RGBA
+  initializeCommonMembers(width, height, 4);
+  mFormat = TextureFormat::RGBA8();
+  mFormat.InternalFormat = format;
+  Bind();
+  // Minification is GL_LINEAR, level 0 alone is complete
+  glCompressedTexImage2D(GL_TEXTURE_2D, 0, format, mWidth, mHeight, 0, size,
+                         data);
+  mBytes = size;
+  Unbind();
 }
 
 void Texture::Save(const std::string &path) {
+  OMVEX_PROFILE_SCOPE("Texture::Save");
   Bind();
 
-  // Always allocate space for RGBA (4 channels), even if the original was RGB
-  int imageSize = mWidth * mHeight * 4;
-  unsigned char *data = new unsigned char[imageSize];
+  // Always read RGBA (4 channels), even if the original was RGB
+  std::vector<unsigned char> data(size_t(mWidth) * mHeight * 4);
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, data.data());
+  Unbind();
 
-  // Read pixels from OpenGL (forcing RGBA format)
-  glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+  Save(path, PixelBuffer(mWidth, mHeight, 4, 1, std::move(data)));
+}
 
-  // Save as PNG using stb_image_write
-  if (!stbi_write_png(path.c_str(), mWidth, mHeight, 4, data, mWidth * 4)) {
+bool Texture::Save(const std::string &path, const PixelBuffer &pixels) {
+  OMVEX_PROFILE_SCOPE("Texture::Save");
+  std::vector<unsigned char> png;
+  bool saved = PngEncoder().Encode(pixels, png);
+  if (saved) {
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char *>(png.data()), png.size());
+    saved = file.good();
+  }
+  if (!saved) {
     Logger::Error("Failed to save texture to: " + path);
+    return false;
   }
-
-  // Cleanup
-  delete[] data;
-  Unbind();
+  return true;
 }
@@ -0,0 +1,120 @@
+#include "Rendering/Textures/TextureCache.h"
+
+#include "Core/Logger.h"
+#include "Utilities/CacheFile.h"
+#include "Utilities/FileSystem.h"
+#include "Utilities/MappedFile.h"
+
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+
+namespace {
+constexpr char MAGIC[8] = {'O', 'M', 'V', 'X', 'T', 'E', 'X', '0'};
+
+struct CacheHeader {
+  char Magic[8];
+  uint32_t Version;
+  uint32_t Format; // 0 for raw pixels
+  int32_t Width;
+  int32_t Height;
+  int32_t Channels;
+  int32_t Padding;
+  uint64_t SourceSize;
+  int64_t SourceTime;
+  uint64_t SourceHash;
+  uint64_t DataSize;
+};
+} // namespace
+
+TextureCache::TextureCache(const std::string &folder) : mFolder(folder) {
+  if (!mFolder.empty()) FileSystem::CreateDir(mFolder);
+}
+
+std::string TextureCache::cachePath(const std::string &path, int targetHeight,
+                                    TextureCompression mode) const {
+  std::string key = std::filesystem::absolute(path).string() + "@" +
+                    std::to_string(targetHeight) + "/" +
+                    std::to_string(static_cast<int>(mode));
+  return CacheFile::GetPath(mFolder, key, ".tex");
+}
+
+bool TextureCache::Load(const std::string &path, int targetHeight,
+                        TextureCompression mode,
+                        DecodedTexture &texture) const {
+  std::string target = cachePath(path, targetHeight, mode);
+  MappedFile file(target);
+  if (!file.IsOpen() || file.GetSize() < sizeof(CacheHeader)) return false;
+
+  CacheHeader header;
+  std::memcpy(&header, file.GetData(), sizeof(header));
+  if (std::memcmp(header.Magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      header.Version != Version ||
+      header.Format != BlockCompression::GetFormat(mode) ||
+      sizeof(CacheHeader) + header.DataSize > file.GetSize()) {
+    return false;
+  }
+  bool touched = false;
+  if (!CacheFile::IsSourceUnchanged(path, header.SourceSize, header.SourceTime,
+                                    header.SourceHash, touched)) {
+    return false;
+  }
+
+  const unsigned char *data = file.GetData() + sizeof(CacheHeader);
+  std::vector<unsigned char> owned(data, data + header.DataSize);
+  texture.Path = path;
+  if (header.Format != 0) {
+    texture.Compressed.Format = header.Format;
+    texture.Compressed.Width = header.Width;
+    texture.Compressed.Height = header.Height;
+    texture.Compressed.Data = std::move(owned);
+  } else {
+    texture.Pixels = PixelBuffer(header.Width, header.Height, header.Channels,
+                                 1, std::move(owned));
+  }
+  file.Close();
+  // Store the new time of a touched source so later loads skip the hash
+  if (touched) {
+    CacheFile::WriteAt(target, offsetof(CacheHeader, SourceTime),
+                       &header.SourceTime, sizeof(header.SourceTime));
+  }
+  return true;
+}
+
+bool TextureCache::Save(const std::string &path, int targetHeight,
+                        TextureCompression mode,
+                        const DecodedTexture &texture) const {
+  CacheHeader header = {};
+  std::memcpy(header.Magic, MAGIC, sizeof(MAGIC));
+  header.Version = Version;
+  header.Format = texture.Compressed.Format;
+  if (!CacheFile::GetSourceInfo(path, header.SourceSize, header.SourceTime) ||
+      !CacheFile::HashSource(path, header.SourceHash)) {
+    return false;
+  }
+
+  const unsigned char *data = nullptr;
+  if (texture.IsCompressed()) {
+    header.Width = texture.Compressed.Width;
+    header.Height = texture.Compressed.Height;
+    header.Channels = 4;
+    data = texture.Compressed.Data.data();
+  } else {
+    header.Width = texture.Pixels.GetWidth();
+    header.Height = texture.Pixels.GetHeight();
+    header.Channels = texture.Pixels.GetChannels();
+    data = texture.Pixels.GetData();
+  }
+  header.DataSize = texture.GetSize();
+
+  std::vector<unsigned char> buffer(sizeof(CacheHeader) + header.DataSize);
+  std::memcpy(buffer.data(), &header, sizeof(header));
+  std::memcpy(buffer.data() + sizeof(header), data, header.DataSize);
+
+  std::string target = cachePath(path, targetHeight, mode);
+  if (!CacheFile::WriteAtomic(target, buffer)) {
+    Logger::Warn("TextureCache: Failed to write " + target);
+    return false;
+  }
+  return true;
+}
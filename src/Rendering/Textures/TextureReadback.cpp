@@ -0,0 +1,114 @@
+#include "Rendering/Textures/TextureReadback.h"
+
+#include "Core/Logger.h"
+#include "Utilities/Profiler.h"
+#include "Utilities/StageStats.h"
+
+#include <thread>
+
+constexpr GLuint64 WAIT_TIMEOUT_NS = 1000000000;
+
+TextureReadback::TextureReadback(int numSlots) {
+  for (int i = 0; i < numSlots; i++) {
+    mSlots.push_back(std::make_unique<Slot>());
+  }
+}
+
+TextureReadback::~TextureReadback() {
+  Flush();
+  for (auto &slot : mSlots) {
+    waitReleased(*slot);
+    if (slot->Buffer) slot->Buffer->Delete();
+  }
+}
+
+void TextureReadback::Request(const Texture &texture, const std::string &path,
+                              int tag, bool dropAlpha) {
+  OMVEX_PROFILE_SCOPE("TextureReadback::Request");
+  // Ring is full, the oldest slot has to be consumed before reuse
+  if (mPending == mSlots.size()) {
+    while (!deliverOldest(WAIT_TIMEOUT_NS)) {
+    }
+  }
+
+  Slot &slot = *mSlots[mNext];
+  waitReleased(slot);
+
+  const TextureFormat &format = texture.GetFormat();
+  glm::vec2 size = texture.GetSize();
+  slot.Width = static_cast<int>(size.x);
+  slot.Height = static_cast<int>(size.y);
+  GLenum readFormat = format.Format;
+  slot.Channels = format.Channels;
+  if (dropAlpha && format.Format == GL_RGBA &&
+      format.Type == GL_UNSIGNED_BYTE) {
+    readFormat = GL_RGB;
+    slot.Channels = 3;
+  }
+  slot.BytesPerChannel = format.BytesPerChannel;
+  slot.Path = path;
+  slot.Tag = tag;
+  slot.RequestedAt = Profiler::Now();
+  GLsizeiptr bytes = GLsizeiptr(slot.Width) * slot.Height * slot.Channels *
+                     slot.BytesPerChannel;
+  // Grow only, color and segmentation requests of different sizes share
+  // the ring
+  if (!slot.Buffer || slot.Buffer->GetSize() < bytes) {
+    if (slot.Buffer) slot.Buffer->Delete();
+    slot.Buffer = std::make_unique<PBO>(bytes);
+  }
+
+  // Copy into the bound pack buffer, returns without waiting for the GPU
+  slot.Buffer->Bind();
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  texture.Bind();
+  glGetTexImage(GL_TEXTURE_2D, 0, readFormat, format.Type, nullptr);
+  texture.Unbind();
+  slot.Buffer->Unbind();
+  slot.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+  mNext = (mNext + 1) % mSlots.size();
+  mPending++;
+}
+
+void TextureReadback::Poll() {
+  while (mPending > 0 && deliverOldest(0)) {
+  }
+}
+
+void TextureReadback::Flush() {
+  while (mPending > 0) {
+    deliverOldest(WAIT_TIMEOUT_NS);
+  }
+}
+
+bool TextureReadback::deliverOldest(GLuint64 timeout) {
+  Slot &slot = *mSlots[mOldest];
+  GLenum status =
+      glClientWaitSync(slot.Fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+  if (status == GL_TIMEOUT_EXPIRED) return false;
+  if (status == GL_WAIT_FAILED) {
+    Logger::Error("TextureReadback: Fence wait failed for " + slot.Path);
+  }
+  glDeleteSync(slot.Fence);
+  // From the copy being issued until the pixels can be mapped. It spans
+  // frames and overlaps other scopes, so it is not traced
+  StageStats::Record(Stage::Readback, slot.RequestedAt, Profiler::Now());
+  slot.Fence = nullptr;
+  mOldest = (mOldest + 1) % mSlots.size();
+  mPending--;
+
+  slot.InUse = true;
+  Slot *released = &slot;
+  PixelBuffer pixels(slot.Width, slot.Height, slot.Channels,
+                     slot.BytesPerChannel, slot.Buffer->GetMapped(),
+                     [released]() { released->InUse = false; });
+  if (mWriter) mWriter(slot.Path, slot.Tag, std::move(pixels));
+  return true;
+}
+
+void TextureReadback::waitReleased(Slot &slot) {
+  while (slot.InUse) {
+    std::this_thread::yield();
+  }
+}
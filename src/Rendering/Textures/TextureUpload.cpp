@@ -0,0 +1,64 @@
+#include "Rendering/Textures/TextureUpload.h"
+
+#include "Core/Logger.h"
+
+#include <cstring>
+
+constexpr GLuint64 WAIT_TIMEOUT_NS = 1000000000;
+
+TextureUpload::TextureUpload(int numSlots) : mSlots(numSlots) {}
+
+TextureUpload::~TextureUpload() {
+  for (Slot &slot : mSlots) {
+    waitFence(slot);
+    if (slot.Buffer) slot.Buffer->Delete();
+  }
+}
+
+void TextureUpload::Upload(Texture &texture, const PixelBuffer &pixels) {
+  Slot &slot = stage(pixels.GetData(), pixels.GetSize());
+  // With an unpack buffer bound the data pointer is an offset into it
+  texture.SetPixels(pixels.GetWidth(), pixels.GetHeight(),
+                    pixels.GetChannels(), nullptr);
+  slot.Buffer->Unbind();
+  slot.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void TextureUpload::Upload(Texture &texture, const CompressedImage &image) {
+  Slot &slot = stage(image.Data.data(), image.Data.size());
+  texture.SetCompressedPixels(image.Format, image.Width, image.Height,
+                              static_cast<GLsizei>(image.Data.size()),
+                              nullptr);
+  slot.Buffer->Unbind();
+  slot.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+TextureUpload::Slot &TextureUpload::stage(const void *data, size_t size) {
+  Slot &slot = mSlots[mNext];
+  mNext = (mNext + 1) % mSlots.size();
+  // The GPU may still be sourcing the image from the last round
+  waitFence(slot);
+
+  GLsizeiptr bytes = static_cast<GLsizeiptr>(size);
+  if (!slot.Buffer || slot.Buffer->GetSize() < bytes) {
+    if (slot.Buffer) slot.Buffer->Delete();
+    slot.Buffer = std::make_unique<PBO>(bytes, GL_PIXEL_UNPACK_BUFFER);
+  }
+  std::memcpy(slot.Buffer->GetMapped(), data, size);
+  slot.Buffer->Bind();
+  return slot;
+}
+
+void TextureUpload::waitFence(Slot &slot) {
+  if (!slot.Fence) return;
+  GLenum status = GL_TIMEOUT_EXPIRED;
+  while (status == GL_TIMEOUT_EXPIRED) {
+    status = glClientWaitSync(slot.Fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+                              WAIT_TIMEOUT_NS);
+  }
+  if (status == GL_WAIT_FAILED) {
+    Logger::Error("TextureUpload: Fence wait failed");
+  }
+  glDeleteSync(slot.Fence);
+  slot.Fence = nullptr;
+}
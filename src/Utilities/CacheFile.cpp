@@ -0,0 +1,105 @@
+#include "Utilities/CacheFile.h"
+
+#include "Utilities/MappedFile.h"
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+namespace CacheFile {
+
+uint64_t HashBytes(const unsigned char *data, size_t size, uint64_t hash) {
+  for (size_t i = 0; i < size; i++) {
+    hash ^= data[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+bool GetSourceInfo(const std::string &path, uint64_t &size, int64_t &time) {
+  std::error_code error;
+  size = std::filesystem::file_size(path, error);
+  if (error) return false;
+  auto writeTime = std::filesystem::last_write_time(path, error);
+  if (error) return false;
+  time = static_cast<int64_t>(writeTime.time_since_epoch().count());
+  return true;
+}
+
+bool HashSource(const std::string &path, uint64_t &hash) {
+  MappedFile source(path);
+  if (!source.IsOpen()) return false;
+  hash = HashBytes(source.GetData(), source.GetSize());
+  return true;
+}
+
+bool IsSourceUnchanged(const std::string &path, uint64_t size, int64_t &time,
+                       uint64_t hash, bool &touched) {
+  touched = false;
+  uint64_t sourceSize = 0;
+  int64_t sourceTime = 0;
+  if (!GetSourceInfo(path, sourceSize, sourceTime)) return false;
+  if (sourceSize != size) return false;
+  if (sourceTime == time) return true;
+  uint64_t sourceHash = 0;
+  if (!HashSource(path, sourceHash) || sourceHash != hash) return false;
+  time = sourceTime;
+  touched = true;
+  return true;
+}
+
+std::string GetPath(const std::string &folder, const std::string &key,
+                    const std::string &extension) {
+  uint64_t hash = HashBytes(reinterpret_cast<const unsigned char *>(key.data()),
+                            key.size());
+  std::ostringstream oss;
+  oss << folder << "/" << std::hex << std::setfill('0') << std::setw(16)
+      << hash << extension;
+  return oss.str();
+}
+
+bool WriteAt(const std::string &path, size_t offset, const void *data,
+             size_t size) {
+  std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+  if (!file.is_open()) return false;
+  file.seekp(static_cast<std::streamoff>(offset));
+  file.write(static_cast<const char *>(data), size);
+  return file.good();
+}
+
+bool WriteAtomic(const std::string &path,
+                 const std::vector<unsigned char> &buffer) {
+  // Worker processes fill the same cache, thread ids alone can repeat
+  // across them
+#ifdef _WIN32
+  int processId = _getpid();
+#else
+  int processId = static_cast<int>(getpid());
+#endif
+  std::ostringstream temporary;
+  temporary << path << "." << processId << "." << std::this_thread::get_id()
+            << ".tmp";
+  {
+    std::ofstream file(temporary.str(), std::ios::binary);
+    if (!file.is_open()) return false;
+    file.write(reinterpret_cast<const char *>(buffer.data()), buffer.size());
+    if (!file) return false;
+  }
+  std::error_code error;
+  std::filesystem::rename(temporary.str(), path, error);
+  if (error) {
+    std::filesystem::remove(temporary.str(), error);
+    return false;
+  }
+  return true;
+}
+
+} // namespace CacheFile
@@ -34,7 +34,7 @@ std::string FindExistingFolder(const std::vector<std::string> paths) {
   return "";
 }
 void CreateDir(const std::string &directoryPath) {
-  std::filesystem::create_directory(directoryPath);
+  std::filesystem::create_directories(directoryPath);
 }
 
 std::string SelectFolder(const std::string &path) {
@@ -0,0 +1,62 @@
+#include "Utilities/MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string &path) {
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE) return;
+  mFile = file;
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) return;
+  mSize = static_cast<size_t>(size.QuadPart);
+
+  mMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mMapping) return;
+  mData = static_cast<const unsigned char *>(
+      MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+}
+void MappedFile::Close() {
+  if (mData) UnmapViewOfFile(mData);
+  if (mMapping) CloseHandle(mMapping);
+  if (mFile) CloseHandle(mFile);
+  mData = nullptr;
+  mMapping = nullptr;
+  mFile = nullptr;
+  mSize = 0;
+}
+#else
+MappedFile::MappedFile(const std::string &path) {
+  mFile = open(path.c_str(), O_RDONLY);
+  if (mFile < 0) return;
+
+  struct stat info;
+  if (fstat(mFile, &info) != 0 || info.st_size == 0) return;
+  mSize = static_cast<size_t>(info.st_size);
+
+  void *data = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, mFile, 0);
+  if (data == MAP_FAILED) return;
+  mData = static_cast<const unsigned char *>(data);
+}
+void MappedFile::Close() {
+  if (mData) munmap(const_cast<unsigned char *>(mData), mSize);
+  if (mFile >= 0) close(mFile);
+  mData = nullptr;
+  mFile = -1;
+  mSize = 0;
+}
+#endif
+
+MappedFile::~MappedFile() { Close(); }
@@ -0,0 +1,282 @@
+#include "Utilities/Profiler.h"
+
+#include "Core/Logger.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace {
+constexpr uint64_t RING_SIZE = 1 << 14;
+constexpr double STAT_SMOOTHING = 0.05;
+constexpr uint64_t STAT_WINDOW_NS = 1000000000;
+
+struct Ring {
+  ProfileEvent Events[RING_SIZE];
+  // Total events written, only the owning thread advances it
+  std::atomic<uint64_t> Head{0};
+  std::atomic<const char *> Name{nullptr};
+  std::atomic<bool> Owned{true};
+  int Id = 0;
+  bool Gpu = false;
+  uint64_t Collected = 0; // Touched by Collect only
+};
+
+// Guards the list, not the events. Rings are never freed, a ring whose
+// thread exited is handed to the next new thread.
+std::mutex sRingsMutex;
+std::vector<std::unique_ptr<Ring>> sRings;
+
+Ring *acquireRing(bool gpu) {
+  std::lock_guard<std::mutex> lock(sRingsMutex);
+  if (!gpu) {
+    for (auto &ring : sRings) {
+      if (!ring->Gpu && !ring->Owned) {
+        ring->Owned = true;
+        ring->Name = nullptr;
+        return ring.get();
+      }
+    }
+  }
+  sRings.push_back(std::make_unique<Ring>());
+  Ring *ring = sRings.back().get();
+  ring->Id = static_cast<int>(sRings.size());
+  ring->Gpu = gpu;
+  if (gpu) ring->Name = "GPU";
+  return ring;
+}
+
+struct ThreadRing {
+  Ring *Events = acquireRing(false);
+  ~ThreadRing() { Events->Owned = false; }
+};
+
+Ring &threadRing() {
+  thread_local ThreadRing local;
+  return *local.Events;
+}
+
+Ring &gpuRing() {
+  static Ring *ring = acquireRing(true);
+  return *ring;
+}
+
+std::vector<Ring *> getRings() {
+  std::lock_guard<std::mutex> lock(sRingsMutex);
+  std::vector<Ring *> rings;
+  for (auto &ring : sRings)
+    rings.push_back(ring.get());
+  return rings;
+}
+
+void push(Ring &ring, const char *name, uint64_t startNs, uint64_t endNs) {
+  uint64_t head = ring.Head.load(std::memory_order_relaxed);
+  ProfileEvent &event = ring.Events[head % RING_SIZE];
+  event.Name = name;
+  event.StartNs = startNs;
+  event.DurationNs = endNs > startNs ? endNs - startNs : 0;
+  ring.Head.store(head + 1, std::memory_order_release);
+}
+
+// Appends the events [from, head) still in the ring, returns head
+uint64_t readRing(const Ring &ring, uint64_t from,
+                  std::vector<ProfileEvent> &out) {
+  uint64_t head = ring.Head.load(std::memory_order_acquire);
+  uint64_t begin = std::max(from, head > RING_SIZE ? head - RING_SIZE : 0);
+  size_t first = out.size();
+  for (uint64_t i = begin; i < head; i++) {
+    out.push_back(ring.Events[i % RING_SIZE]);
+  }
+  // The writer may have lapped the copy, drop the slots it reused
+  std::atomic_thread_fence(std::memory_order_acquire);
+  uint64_t after = ring.Head.load(std::memory_order_relaxed);
+  uint64_t valid = after > RING_SIZE ? after - RING_SIZE : 0;
+  if (valid > begin) {
+    size_t dropped = static_cast<size_t>(std::min(valid, head) - begin);
+    out.erase(out.begin() + first, out.begin() + first + dropped);
+  }
+  return head;
+}
+
+// GPU queries are issued and resolved on the GL thread only
+struct GpuQuery {
+  GLuint Begin = 0;
+  GLuint End = 0;
+  const char *Name = nullptr;
+};
+std::vector<GpuQuery> sQueries;
+std::vector<int> sFreeQueries;
+std::deque<int> sPendingQueries;
+
+struct Rolling {
+  int Count = 0;
+  double LastMs = 0.0;
+  double AverageMs = 0.0;
+  double WindowMaxMs = 0.0;
+  double PreviousMaxMs = 0.0;
+  uint64_t WindowStart = 0;
+};
+std::mutex sStatsMutex;
+std::map<std::pair<std::string, bool>, Rolling> sStats;
+std::vector<ProfileEvent> sCollected;
+} // namespace
+
+uint64_t Profiler::Now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void Profiler::Record(const char *name, uint64_t startNs, uint64_t endNs) {
+  push(threadRing(), name, startNs, endNs);
+}
+
+void Profiler::SetThreadName(const char *name) {
+#ifdef OMVEX_PROFILING
+  // Without the timers no thread needs a ring
+  Ring &ring = threadRing();
+  if (ring.Name.load(std::memory_order_relaxed) != name) ring.Name = name;
+#endif
+}
+
+int Profiler::BeginGpu(const char *name) {
+  if (!GLAD_GL_VERSION_3_3) return -1;
+  int id;
+  if (sFreeQueries.empty()) {
+    GpuQuery query;
+    glGenQueries(1, &query.Begin);
+    glGenQueries(1, &query.End);
+    sQueries.push_back(query);
+    id = static_cast<int>(sQueries.size()) - 1;
+  } else {
+    id = sFreeQueries.back();
+    sFreeQueries.pop_back();
+  }
+  sQueries[id].Name = name;
+  glQueryCounter(sQueries[id].Begin, GL_TIMESTAMP);
+  return id;
+}
+
+void Profiler::EndGpu(int query) {
+  if (query < 0) return;
+  glQueryCounter(sQueries[query].End, GL_TIMESTAMP);
+  sPendingQueries.push_back(query);
+}
+
+void Profiler::PollGpu(bool wait) {
+  if (sPendingQueries.empty()) return;
+  // GPU timestamps have their own epoch, move them onto the CPU clock
+  GLint64 gpuNow = 0;
+  glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+  int64_t offset = static_cast<int64_t>(Now()) - gpuNow;
+
+  // Queries finish in submission order, stop at the first pending one
+  while (!sPendingQueries.empty()) {
+    GpuQuery &query = sQueries[sPendingQueries.front()];
+    if (!wait) {
+      GLint available = 0;
+      glGetQueryObjectiv(query.End, GL_QUERY_RESULT_AVAILABLE, &available);
+      if (!available) break;
+    }
+    GLuint64 begin = 0, end = 0;
+    glGetQueryObjectui64v(query.Begin, GL_QUERY_RESULT, &begin);
+    glGetQueryObjectui64v(query.End, GL_QUERY_RESULT, &end);
+    push(gpuRing(), query.Name, begin + offset, end + offset);
+    sFreeQueries.push_back(sPendingQueries.front());
+    sPendingQueries.pop_front();
+  }
+}
+
+void Profiler::Collect() {
+  std::lock_guard<std::mutex> lock(sStatsMutex);
+  uint64_t now = Now();
+  for (Ring *ring : getRings()) {
+    sCollected.clear();
+    ring->Collected = readRing(*ring, ring->Collected, sCollected);
+    for (const ProfileEvent &event : sCollected) {
+      Rolling &stat = sStats[{event.Name, ring->Gpu}];
+      double ms = event.DurationNs / 1e6;
+      stat.AverageMs =
+          stat.Count == 0
+              ? ms
+              : stat.AverageMs + STAT_SMOOTHING * (ms - stat.AverageMs);
+      stat.Count++;
+      stat.LastMs = ms;
+      stat.WindowMaxMs = std::max(stat.WindowMaxMs, ms);
+    }
+  }
+  for (auto &[key, stat] : sStats) {
+    if (now - stat.WindowStart < STAT_WINDOW_NS) continue;
+    stat.PreviousMaxMs = stat.WindowMaxMs;
+    stat.WindowMaxMs = 0.0;
+    stat.WindowStart = now;
+  }
+}
+
+std::vector<ProfileStat> Profiler::GetStats() {
+  std::lock_guard<std::mutex> lock(sStatsMutex);
+  std::vector<ProfileStat> stats;
+  for (const auto &[key, rolling] : sStats) {
+    ProfileStat stat;
+    stat.Name = key.first;
+    stat.Gpu = key.second;
+    stat.Count = rolling.Count;
+    stat.LastMs = rolling.LastMs;
+    stat.AverageMs = rolling.AverageMs;
+    stat.MaxMs = std::max(rolling.WindowMaxMs, rolling.PreviousMaxMs);
+    stats.push_back(stat);
+  }
+  return stats;
+}
+
+bool Profiler::WriteTrace(const std::string &path, uint64_t sinceNs) {
+  FILE *file = std::fopen(path.c_str(), "w");
+  if (!file) {
+    Logger::Error("Profiler: Failed to open " + path);
+    return false;
+  }
+  std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+  bool first = true;
+  size_t written = 0;
+  std::vector<ProfileEvent> events;
+  for (Ring *ring : getRings()) {
+    const char *name = ring->Name.load();
+    std::string threadName =
+        name ? name : "Thread " + std::to_string(ring->Id);
+    std::fprintf(file,
+                 "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                 "\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                 first ? "" : ",", ring->Id, threadName.c_str());
+    first = false;
+
+    events.clear();
+    readRing(*ring, 0, events);
+    for (const ProfileEvent &event : events) {
+      if (event.StartNs < sinceNs) continue;
+      // Complete events, microseconds from the start of the run
+      std::fprintf(file,
+                   ",{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,"
+                   "\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                   event.Name, ring->Gpu ? "gpu" : "cpu", ring->Id,
+                   (event.StartNs - sinceNs) / 1e3, event.DurationNs / 1e3);
+      written++;
+    }
+  }
+  std::fprintf(file, "]}\n");
+  bool ok = std::ferror(file) == 0;
+  std::fclose(file);
+  if (!ok) {
+    Logger::Error("Profiler: Failed to write " + path);
+    return false;
+  }
+  Logger::Info("Profiler: Wrote " + std::to_string(written) + " events to " +
+               path);
+  return true;
+}
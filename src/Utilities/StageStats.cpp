@@ -0,0 +1,82 @@
+#include "Utilities/StageStats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <vector>
+
+namespace {
+constexpr size_t STAGE_COUNT = static_cast<size_t>(Stage::Count);
+
+std::atomic<bool> sEnabled{false};
+std::mutex sMutex;
+std::vector<double> sSamples[STAGE_COUNT];
+
+// Nearest rank on sorted samples
+double percentile(const std::vector<double> &sorted, double p) {
+  size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+  return sorted[std::min(sorted.size(), std::max<size_t>(1, rank)) - 1];
+}
+} // namespace
+
+void StageStats::SetEnabled(bool enabled) { sEnabled = enabled; }
+bool StageStats::IsEnabled() { return sEnabled; }
+
+void StageStats::Record(Stage stage, uint64_t startNs, uint64_t endNs,
+                        const char *traceName) {
+#ifdef OMVEX_PROFILING
+  if (traceName) Profiler::Record(traceName, startNs, endNs);
+#else
+  (void)traceName;
+#endif
+  if (!sEnabled || stage == Stage::Count) return;
+  double ms = endNs > startNs ? (endNs - startNs) / 1e6 : 0.0;
+  std::lock_guard<std::mutex> lock(sMutex);
+  sSamples[static_cast<size_t>(stage)].push_back(ms);
+}
+
+void StageStats::Reset() {
+  std::lock_guard<std::mutex> lock(sMutex);
+  for (std::vector<double> &samples : sSamples) {
+    samples.clear();
+  }
+}
+
+StageSummary StageStats::GetSummary(Stage stage) {
+  StageSummary summary;
+  if (stage == Stage::Count) return summary;
+  std::vector<double> sorted;
+  {
+    std::lock_guard<std::mutex> lock(sMutex);
+    sorted = sSamples[static_cast<size_t>(stage)];
+  }
+  if (sorted.empty()) return summary;
+  std::sort(sorted.begin(), sorted.end());
+  double total = 0.0;
+  for (double ms : sorted)
+    total += ms;
+  summary.Count = static_cast<int>(sorted.size());
+  summary.P50Ms = percentile(sorted, 0.50);
+  summary.P99Ms = percentile(sorted, 0.99);
+  summary.MeanMs = total / sorted.size();
+  summary.MaxMs = sorted.back();
+  return summary;
+}
+
+const char *StageStats::GetName(Stage stage) {
+  switch (stage) {
+  case Stage::Settle:
+    return "settle";
+  case Stage::Render:
+    return "render";
+  case Stage::Readback:
+    return "readback";
+  case Stage::Encode:
+    return "encode";
+  case Stage::Write:
+    return "write";
+  default:
+    return "unknown";
+  }
+}
@@ -0,0 +1,22 @@
+#include "Core/HeadlessApplication.h"
+#include "Core/Logger.h"
+
+#include <cstring>
+#include <iostream>
+
+// Loads the example scene unless --cameras/--models are given and renders
+// --renders images at each resolution, takes the same flags as --headless
+int main(int argc, char **argv) {
+  // stdout only carries the json report, omvex_bench > report.json
+  Logger::SetConsole(std::cerr);
+  HeadlessSettings settings = HeadlessSettings::Parse(argc, argv);
+  bool rendersGiven = false;
+  for (int i = 1; i < argc; i++) {
+    rendersGiven |= std::strcmp(argv[i], "--renders") == 0;
+  }
+  // Enough samples for a meaningful p99
+  if (!rendersGiven) settings.NumRenders = 200;
+
+  HeadlessApplication application(settings);
+  return application.RunBenchmark();
+}
@@ -1,6 +1,15 @@
 #include "Core/Application.h"
+#include "Core/HeadlessApplication.h"
 
-int main() {
+#include <cstring>
+
+int main(int argc, char **argv) {
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--headless") == 0) {
+      HeadlessApplication application(HeadlessSettings::Parse(argc, argv));
+      return application.Run();
+    }
+  }
   Application application;
   application.Run();
 }